@@ -0,0 +1,180 @@
+/*
+Builds a BVH over N static cubes and times it against brute force:
+- the build, on one thread then on the pool
+- a refit after a tenth of the cubes turned
+- frustum culling, against the SIMD brute force of Culling.hpp
+- pick rays, against testing every box
+and checks both sides agree.
+
+usage : BvhBench [cubeCount] (default 300000)
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Bvh.hpp"
+#include "Culling.hpp"
+#include "Movable.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// @returns the best time of `runs` runs in milliseconds
+template <typename F>
+double bestTime(int runs, F&& run) {
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < runs; i++) {
+        Clock::time_point start = Clock::now();
+        run();
+        best = std::min(best, millisecondsSince(start));
+    }
+    return best;
+}
+
+std::vector<Aabb> computeBounds(const std::vector<Transform>& transforms) {
+    std::vector<Aabb> bounds;
+    bounds.reserve(transforms.size());
+    for (const Transform& transform : transforms)
+        bounds.push_back(worldBounds(transform));
+    return bounds;
+}
+
+// closest box along the ray, testing them all
+std::optional<RayHit> raycastBruteForce(const std::vector<Aabb>& bounds, glm::vec3 origin, glm::vec3 direction) {
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    std::optional<RayHit> hit;
+    float closest = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < bounds.size(); i++) {
+        glm::vec3 t0 = (bounds[i].min - origin) * inverseDirection;
+        glm::vec3 t1 = (bounds[i].max - origin) * inverseDirection;
+        glm::vec3 entries = glm::min(t0, t1), exits = glm::max(t0, t1);
+        float entry = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+        float exit = std::min(std::min(exits.x, exits.y), exits.z);
+        if (entry <= exit && entry <= closest) {
+            closest = entry;
+            hit = RayHit{static_cast<uint32_t>(i), entry};
+        }
+    }
+    return hit;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 300000;
+
+    // cubes of various sizes in a city block like slab, denser near the ground
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> ground(-500.0f, 500.0f);
+    std::exponential_distribution<float> height(0.05f);
+    std::uniform_real_distribution<float> size(0.5f, 3.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::vector<Transform> transforms;
+    transforms.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 position(ground(random), height(random), ground(random));
+        glm::quat rotation = glm::angleAxis(angle(random), glm::vec3(0.0f, 1.0f, 0.0f));
+        transforms.emplace_back(position, glm::vec3(size(random)), rotation);
+    }
+    std::vector<Aabb> bounds = computeBounds(transforms);
+
+    ThreadPool pool;
+    std::printf("%zu cubes, %zu worker threads\n", count, pool.getThreadCount());
+
+    // Build
+    Bvh bvh;
+    double serialBuild = bestTime(3, [&]() { bvh.build(bounds); });
+    double parallelBuild = bestTime(3, [&]() { bvh.build(bounds, pool); });
+    std::printf("build   : %8.3f ms serial | %8.3f ms parallel | %zu nodes\n", serialBuild, parallelBuild,
+                bvh.getNodes().size());
+
+    // Refit, a tenth of the cubes turn, the versions tell which bounds to update
+    std::vector<uint64_t> boundsVersions;
+    boundsVersions.reserve(count);
+    for (const Transform& transform : transforms)
+        boundsVersions.push_back(transform.getVersion());
+    for (size_t i = 0; i < count; i += 10)
+        transforms[i].rotate(glm::angleAxis(0.3f, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+    Clock::time_point boundsStart = Clock::now();
+    size_t moved = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (transforms[i].getVersion() == boundsVersions[i])
+            continue;
+        bounds[i] = worldBounds(transforms[i]);
+        boundsVersions[i] = transforms[i].getVersion();
+        moved++;
+    }
+    double boundsTime = millisecondsSince(boundsStart);
+    double refitTime = bestTime(5, [&]() { bvh.refit(bounds); });
+    std::printf("refit   : %8.3f ms (+ %.3f ms of world bounds for %zu moved cubes)\n", refitTime, boundsTime, moved);
+
+    // Culling, from a few points of view
+    BoundingBoxes boxes;
+    boxes.reserve(count);
+    for (const Aabb& box : bounds)
+        boxes.push(box.min, box.max);
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+    const glm::vec3 eyes[] = {glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(-450.0f, 30.0f, -450.0f),
+                              glm::vec3(0.0f, 300.0f, 0.0f)};
+    const glm::vec3 targets[] = {glm::vec3(1.0f, 2.0f, 0.3f), glm::vec3(0.0f), glm::vec3(10.0f, 0.0f, 0.0f)};
+    VisibleList bvhVisible, simdVisible;
+    for (size_t view = 0; view < std::size(eyes); view++) {
+        Frustum frustum =
+            Frustum::fromMatrix(projection * glm::lookAt(eyes[view], targets[view], glm::vec3(0.0f, 1.0f, 0.0f)));
+        double bvhTime = bestTime(10, [&]() { bvh.cull(frustum, bvhVisible); });
+        double simdTime = bestTime(10, [&]() { cullBoxes(frustum, boxes, simdVisible); });
+
+        std::vector<uint32_t> sorted(bvhVisible.begin(), bvhVisible.end());
+        std::sort(sorted.begin(), sorted.end());
+        bool matches = std::equal(sorted.begin(), sorted.end(), simdVisible.begin(), simdVisible.end());
+        std::printf("cull %zu  : %8.3f ms BVH | %8.3f ms %s brute force | %zu visible%s\n", view, bvhTime, simdTime,
+                    cullingPath(), simdVisible.size(), matches ? "" : " | RESULTS DIFFER");
+    }
+
+    // Pick rays from above the ground, looking around and down
+    const size_t RAY_COUNT = 1000;
+    const size_t CHECKED_RAY_COUNT = 100; // brute force is slow
+    std::vector<glm::vec3> origins, directions;
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (size_t i = 0; i < RAY_COUNT; i++) {
+        origins.push_back(glm::vec3(ground(random), 10.0f, ground(random)));
+        directions.push_back(glm::normalize(glm::vec3(unit(random), -0.3f + 0.2f * unit(random), unit(random))));
+    }
+    size_t hits = 0, mismatches = 0;
+    Clock::time_point bvhStart = Clock::now();
+    for (size_t i = 0; i < RAY_COUNT; i++)
+        hits += bvh.raycast(origins[i], directions[i]).has_value();
+    double bvhRays = millisecondsSince(bvhStart);
+
+    double bruteRays = 0.0;
+    for (size_t i = 0; i < CHECKED_RAY_COUNT; i++) {
+        Clock::time_point bruteStart = Clock::now();
+        std::optional<RayHit> expected = raycastBruteForce(bounds, origins[i], directions[i]);
+        bruteRays += millisecondsSince(bruteStart);
+        std::optional<RayHit> hit = bvh.raycast(origins[i], directions[i]);
+        // equal distances may pick either box
+        if (expected.has_value() != hit.has_value() || (hit && hit->distance != expected->distance))
+            mismatches++;
+    }
+    std::printf("rays    : %8.3f us BVH | %8.3f us brute force | %zu / %zu hit%s\n", bvhRays * 1000.0 / RAY_COUNT,
+                bruteRays * 1000.0 / CHECKED_RAY_COUNT, hits, RAY_COUNT, mismatches == 0 ? "" : " | RESULTS DIFFER");
+    return 0;
+}
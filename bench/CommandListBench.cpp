@@ -0,0 +1,118 @@
+/*
+Times the CPU side of a frame of N objects recorded into command lists by
+1, 2, 4, ... worker threads, up to the hardware thread count. Per object:
+its transform and normal matrix, a palette color and a draw submission, the
+instance data going straight in the upload commands. GL is never touched,
+replaying the lists is not timed.
+
+usage : CommandListBench [objectCount] (default 50000)
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "CommandList.hpp"
+#include "Movable.hpp"
+#include "ThreadPool.hpp"
+#include "gl_utils.hpp"
+
+// -- Scene --
+
+struct Object {
+    Transform transform;
+    glm::vec3 axis;
+};
+
+// per instance data of the benchmark, the matrices and a color
+struct ObjectInstance {
+    InstanceTransform transform;
+    glm::vec3 color;
+};
+
+static std::vector<Object> makeObjects(size_t count) {
+    std::vector<Object> objects;
+    objects.reserve(count);
+    const size_t side = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 position(float(i % side), float((i / side) % side), float(i / (side * side)));
+        glm::vec3 axis = glm::normalize(glm::vec3(std::cos(float(i)), std::sin(float(i)), 1.0f));
+        objects.push_back({Transform(position * 3.0f, glm::vec3(1.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f)), axis});
+    }
+    return objects;
+}
+
+// -- Recording --
+
+// what a frame of main.cpp does per cube, for [begin, end)
+static void recordObjects(CommandList& list, std::vector<Object>& objects, size_t begin, size_t end, float time,
+                          glm::vec3 eye) {
+    auto* instances = static_cast<ObjectInstance*>(
+        list.uploadBuffer(1, begin * sizeof(ObjectInstance), (end - begin) * sizeof(ObjectInstance)));
+    for (size_t i = begin; i < end; i++) {
+        Object& object = objects[i];
+        object.transform.setRotation(glm::angleAxis(time, object.axis));
+        instances[i - begin] = {InstanceTransform(object.transform), palette(time / float(i % 16 + 2))};
+    }
+
+    // the instances are written, the pointer may now move with the list
+    for (size_t i = begin; i < end; i++) {
+        DrawSubmission submission{nullptr, nullptr};
+        submission.depth = glm::length(objects[i].transform.getPos() - eye);
+        submission.instanceCount = 1;
+        list.submit(submission);
+    }
+}
+
+// @returns the mean frame time in milliseconds
+static double timeFrames(ThreadPool& pool, std::vector<CommandList>& lists, std::vector<Object>& objects,
+                         int frames) {
+    using Clock = std::chrono::steady_clock;
+    const glm::vec3 eye(-10.0f, 5.0f, -10.0f);
+
+    Clock::time_point start = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        float time = frame / 60.0f;
+        recordParallel(pool, lists, objects.size(), [&](CommandList& list, size_t begin, size_t end) {
+            recordObjects(list, objects, begin, end, time, eye);
+        });
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+}
+
+int main(int argc, char** argv) {
+    size_t objectCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+    std::vector<Object> objects = makeObjects(objectCount);
+
+    const size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    const int FRAMES = 60;
+
+    std::printf("%zu objects, %d frames per run\n", objectCount, FRAMES);
+    double single = 0.0;
+    // 1, 2, 4, ... then every hardware thread
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    for (size_t threads : threadCounts) {
+        ThreadPool pool(threads);
+        std::vector<CommandList> lists(threads);
+
+        timeFrames(pool, lists, objects, 5); // warm up, lists reach their size
+        double frameTime = timeFrames(pool, lists, objects, FRAMES);
+        if (threads == 1)
+            single = frameTime;
+
+        size_t commands = 0;
+        for (const CommandList& list : lists)
+            commands += list.getCommandCount();
+        std::printf("%2zu threads : %8.3f ms/frame, speedup %.2fx, %zu commands\n", threads, frameTime,
+                    single / frameTime, commands);
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+Times frustum culling of N bounding volumes scattered around a camera, the
+SIMD path of the build against the scalar reference, for boxes and spheres,
+and checks both keep the same volumes.
+
+usage : CullingBench [volumeCount] (default 1000000)
+build with -DNATIVE_ARCH=ON to get the AVX path on a CPU that has it
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Culling.hpp"
+
+namespace {
+
+constexpr int RUNS = 20;
+
+// @returns the best time of RUNS runs in milliseconds, noise only ever adds
+template <typename F>
+double bestTime(F&& cull) {
+    using Clock = std::chrono::steady_clock;
+    double best = 1e30;
+    for (int run = 0; run < RUNS; run++) {
+        Clock::time_point start = Clock::now();
+        cull();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+bool sameIndices(const VisibleList& a, const VisibleList& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+void report(const char* volumes, size_t count, double scalar, double simd, const VisibleList& visible,
+            bool matches) {
+    std::printf("%-8s scalar %8.3f ms | %-6s %8.3f ms | speedup %.2fx | %zu / %zu visible%s\n", volumes, scalar,
+                cullingPath(), simd, scalar / simd, visible.size(), count, matches ? "" : " | RESULTS DIFFER");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    // volumes all around the camera, about a tenth lands in view
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> size(0.1f, 2.0f);
+    BoundingBoxes boxes;
+    BoundingSpheres spheres;
+    boxes.reserve(count);
+    spheres.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 extent(size(random), size(random), size(random));
+        boxes.push(center - extent, center + extent);
+        spheres.push(center, glm::length(extent));
+    }
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.2f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Frustum frustum = Frustum::fromMatrix(projection * view);
+
+    VisibleList scalarVisible, simdVisible;
+    std::printf("%zu volumes, best of %d runs\n", count, RUNS);
+
+    double scalar = bestTime([&]() { cullBoxesScalar(frustum, boxes, scalarVisible); });
+    double simd = bestTime([&]() { cullBoxes(frustum, boxes, simdVisible); });
+    report("boxes", count, scalar, simd, simdVisible, sameIndices(scalarVisible, simdVisible));
+
+    scalar = bestTime([&]() { cullSpheresScalar(frustum, spheres, scalarVisible); });
+    simd = bestTime([&]() { cullSpheres(frustum, spheres, simdVisible); });
+    report("spheres", count, scalar, simd, simdVisible, sameIndices(scalarVisible, simdVisible));
+    return 0;
+}
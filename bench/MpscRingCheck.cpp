@@ -0,0 +1,136 @@
+/*
+Checks MpscRing, the queue between the GL debug callback and its logging
+thread:
+- wrap-around, a small ring filled and drained over many laps keeps FIFO order
+- full ring, pushes fail once Capacity values wait and the drops are counted
+- stress, 4 producers push 200000 numbered messages each through a 64 cells
+  ring, retrying when it is full, while one consumer pops: every message
+  arrives once, in order per producer
+Built with -fsanitize=thread where the compiler has it, so a data race in the
+ring fails the run too.
+
+usage : MpscRingCheck, exits with 1 if a check failed
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "MpscRing.hpp"
+
+namespace {
+
+bool s_failed = false;
+
+void check(bool condition, const char* what) {
+    if (condition)
+        return;
+    std::printf("FAILED : %s\n", what);
+    s_failed = true;
+}
+
+// -- Wrap-around --
+
+void checkWrapAround() {
+    constexpr size_t CAPACITY = 4;
+    constexpr size_t LAPS = 1000;
+    MpscRing<size_t, CAPACITY> ring;
+
+    size_t pushed = 0, popped = 0, value = 0;
+    bool ordered = true;
+    // 3 in, 3 out, so the head and tail cross the end of the cells at every offset
+    for (size_t lap = 0; lap < LAPS; lap++) {
+        for (int i = 0; i < 3; i++)
+            pushed += ring.tryPush(pushed);
+        while (ring.tryPop(value))
+            ordered = ordered && value == popped++;
+    }
+    check(pushed == LAPS * 3, "wrap-around : a push failed on a ring with free cells");
+    check(popped == pushed, "wrap-around : values lost");
+    check(ordered, "wrap-around : values out of order");
+}
+
+// -- Full ring --
+
+void checkFullRing() {
+    constexpr size_t CAPACITY = 8;
+    MpscRing<size_t, CAPACITY> ring;
+
+    size_t dropped = 0;
+    for (size_t i = 0; i < CAPACITY + 5; i++)
+        dropped += !ring.tryPush(i);
+    check(dropped == 5, "full ring : pushes past the capacity did not fail");
+
+    // the first CAPACITY values stay, a freed cell takes a push again
+    size_t value = 0;
+    check(ring.tryPop(value) && value == 0, "full ring : the oldest value is not first out");
+    check(ring.tryPush(100), "full ring : a popped cell was not handed back");
+    check(!ring.tryPush(101), "full ring : more than Capacity values queued");
+
+    size_t count = 0, last = 0;
+    while (ring.tryPop(value)) {
+        count++;
+        last = value;
+    }
+    check(count == CAPACITY && last == 100, "full ring : values lost after the drops");
+}
+
+// -- Stress --
+
+struct Message {
+    uint32_t producer;
+    uint32_t index;
+};
+
+void checkStress() {
+    constexpr uint32_t PRODUCERS = 4;
+    constexpr uint32_t MESSAGES_PER_PRODUCER = 200000;
+    MpscRing<Message, 64> ring;
+
+    std::vector<std::thread> producers;
+    for (uint32_t producer = 0; producer < PRODUCERS; producer++) {
+        producers.emplace_back([&ring, producer]() {
+            for (uint32_t index = 0; index < MESSAGES_PER_PRODUCER; index++)
+                while (!ring.tryPush({producer, index}))
+                    std::this_thread::yield();
+        });
+    }
+
+    std::vector<uint32_t> expected(PRODUCERS, 0);
+    size_t received = 0, unknown = 0, reordered = 0;
+    Message message;
+    while (received < size_t(PRODUCERS) * MESSAGES_PER_PRODUCER) {
+        if (!ring.tryPop(message)) {
+            std::this_thread::yield();
+            continue;
+        }
+        received++;
+        if (message.producer >= PRODUCERS) {
+            unknown++;
+            continue;
+        }
+        // a message missing or seen twice breaks the sequence as well
+        reordered += message.index != expected[message.producer];
+        expected[message.producer] = message.index + 1;
+    }
+    for (std::thread& producer : producers)
+        producer.join();
+
+    check(!ring.tryPop(message), "stress : more messages than pushed");
+    check(unknown == 0, "stress : corrupted messages");
+    check(reordered == 0, "stress : messages lost, duplicated or out of order");
+    std::printf("stress : %zu messages from %u producers\n", received, PRODUCERS);
+}
+
+} // namespace
+
+int main() {
+    checkWrapAround();
+    checkFullRing();
+    checkStress();
+
+    std::printf(s_failed ? "MpscRing checks FAILED\n" : "MpscRing checks passed\n");
+    return s_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
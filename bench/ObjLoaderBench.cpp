@@ -0,0 +1,137 @@
+/*
+Compares loadObj (mmap + hand written parser) with a naive std::getline /
+std::istringstream parser on the same file.
+
+usage : ObjLoaderBench [file.obj]
+without a file, a grid mesh of about 260MB is generated in the temp directory
+and removed once both parsers ran
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "ObjLoader.hpp"
+
+// -- Naive reference parser --
+
+static MeshData naiveLoadObj(const char* path) {
+    std::ifstream file(path);
+    std::vector<float> positions, normals, uvs;
+    std::map<std::tuple<long, long, long>, unsigned int> corners;
+
+    MeshData mesh;
+    mesh.stride = OBJ_VERTEX_STRIDE;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string type;
+        stream >> type;
+
+        if (type == "v") {
+            float x, y, z;
+            stream >> x >> y >> z;
+            positions.insert(positions.end(), {x, y, z});
+        } else if (type == "vn") {
+            float x, y, z;
+            stream >> x >> y >> z;
+            normals.insert(normals.end(), {x, y, z});
+        } else if (type == "vt") {
+            float u, v;
+            stream >> u >> v;
+            uvs.insert(uvs.end(), {u, v});
+        } else if (type == "f") {
+            std::vector<unsigned int> face;
+            std::string token;
+            while (stream >> token) {
+                long v = 0, vt = 0, vn = 0;
+                if (std::sscanf(token.c_str(), "%ld/%ld/%ld", &v, &vt, &vn) != 3 &&
+                    std::sscanf(token.c_str(), "%ld//%ld", &v, &vn) != 2)
+                    std::sscanf(token.c_str(), "%ld/%ld", &v, &vt);
+
+                auto key = std::make_tuple(v, vt, vn);
+                auto it = corners.find(key);
+                if (it == corners.end()) {
+                    it = corners.emplace(key, mesh.vertices.size() / OBJ_VERTEX_STRIDE).first;
+                    mesh.vertices.insert(mesh.vertices.end(), &positions[(v - 1) * 3], &positions[(v - 1) * 3] + 3);
+                    if (vn > 0)
+                        mesh.vertices.insert(mesh.vertices.end(), &normals[(vn - 1) * 3], &normals[(vn - 1) * 3] + 3);
+                    else
+                        mesh.vertices.insert(mesh.vertices.end(), {0.0f, 0.0f, 0.0f});
+                    if (vt > 0)
+                        mesh.vertices.insert(mesh.vertices.end(), &uvs[(vt - 1) * 2], &uvs[(vt - 1) * 2] + 2);
+                    else
+                        mesh.vertices.insert(mesh.vertices.end(), {0.0f, 0.0f});
+                }
+                face.push_back(it->second);
+            }
+            for (size_t i = 2; i < face.size(); i++)
+                mesh.indices.insert(mesh.indices.end(), {face[0], face[i - 1], face[i]});
+        }
+    }
+    return mesh;
+}
+
+// -- Test data --
+
+static std::string writeGridObj(int side) {
+    std::string path = (std::filesystem::temp_directory_path() / "ObjLoaderBench.obj").string();
+    std::ofstream file(path);
+    char line[128];
+
+    for (int y = 0; y < side; y++)
+        for (int x = 0; x < side; x++) {
+            std::snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\n", x * 0.01f, y * 0.01f,
+                          0.001f * ((x * 7 + y * 13) % 100), x / float(side), y / float(side));
+            file << line;
+        }
+    file << "vn 0.0000 0.0000 1.0000\n";
+
+    for (int y = 0; y + 1 < side; y++)
+        for (int x = 0; x + 1 < side; x++) {
+            int a = y * side + x + 1, b = a + 1, c = a + side + 1, d = a + side;
+            std::snprintf(line, sizeof(line), "f %d/%d/1 %d/%d/1 %d/%d/1 %d/%d/1\n", a, a, b, b, c, c, d, d);
+            file << line;
+        }
+    return path;
+}
+
+template <typename F>
+static double timeSeconds(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    bool generated = argc <= 1;
+    std::string path = generated ? writeGridObj(1500) : argv[1];
+    double megabytes = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+
+    MeshData fast, naive;
+    double fastTime = timeSeconds([&] { fast = loadObj(path.c_str()); });
+    double naiveTime = timeSeconds([&] { naive = naiveLoadObj(path.c_str()); });
+
+    std::cout << path << " : " << megabytes << " MB, " << fast.vertices.size() / OBJ_VERTEX_STRIDE
+              << " vertices, " << fast.indices.size() / 3 << " triangles\n";
+    std::cout << "loadObj      : " << fastTime << " s (" << megabytes / fastTime << " MB/s)\n";
+    std::cout << "naive getline: " << naiveTime << " s (" << megabytes / naiveTime << " MB/s)\n";
+
+    if (generated)
+        std::filesystem::remove(path);
+
+    // both parse the floats to the nearest value, the vertices match bit for bit
+    if (fast.vertices != naive.vertices || fast.indices != naive.indices) {
+        std::cerr << "mismatch between the two parsers" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,362 @@
+#include "Bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+// -- Private utils --
+
+namespace {
+
+constexpr uint32_t ALL_PLANES = (1u << Frustum::PLANE_COUNT) - 1;
+
+// What is left to test of a box against the frustum
+enum class Containment { OUTSIDE, PARTIAL, INSIDE };
+
+// Tests the planes of `mask`, clears the ones the box is fully inside
+Containment classify(const Frustum& frustum, glm::vec3 min, glm::vec3 max, uint32_t& mask) {
+    const glm::vec3 center = (min + max) * 0.5f;
+    const glm::vec3 extent = (max - min) * 0.5f;
+    for (uint32_t p = 0; p < Frustum::PLANE_COUNT; p++) {
+        if (!(mask & (1u << p)))
+            continue;
+        const glm::vec4& plane = frustum.planes[p];
+        float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        float reach = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+        if (distance + reach < 0.0f)
+            return Containment::OUTSIDE;
+        if (distance - reach >= 0.0f)
+            mask &= ~(1u << p);
+    }
+    return mask == 0 ? Containment::INSIDE : Containment::PARTIAL;
+}
+
+// Distance along the ray to where it enters the box, 0 from inside, infinity
+// on a miss
+float rayEntry(glm::vec3 origin, glm::vec3 inverseDirection, glm::vec3 min, glm::vec3 max) {
+    glm::vec3 t0 = (min - origin) * inverseDirection;
+    glm::vec3 t1 = (max - origin) * inverseDirection;
+    glm::vec3 entries = glm::min(t0, t1), exits = glm::max(t0, t1);
+    float entry = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+    float exit = std::min(std::min(exits.x, exits.y), exits.z);
+    return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+}
+
+} // namespace
+
+// -- Aabb --
+Aabb Aabb::transformed(const glm::mat4& transform) const {
+    // each world axis sums the extreme contributions of the local ones
+    const glm::vec3 translation(transform[3]);
+    Aabb result{translation, translation};
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            float a = transform[column][row] * min[column];
+            float b = transform[column][row] * max[column];
+            result.min[row] += std::min(a, b);
+            result.max[row] += std::max(a, b);
+        }
+    }
+    return result;
+}
+
+Aabb worldBounds(const Movable& movable, const Aabb& local) {
+    return local.transformed(movable.getTransforms());
+}
+
+// -- Build --
+void Bvh::build(std::vector<Aabb> bounds) {
+    if (!reset(std::move(bounds)))
+        return;
+    buildNode(m_nodes, Range{0, 0, static_cast<uint32_t>(m_primitives.size()), 0}, 0, nullptr);
+    m_centers = std::vector<glm::vec3>();
+}
+
+void Bvh::build(std::vector<Aabb> bounds, ThreadPool& pool) {
+    if (!reset(std::move(bounds)))
+        return;
+
+    // the top levels alone, until the ranges are small enough that a few per
+    // worker balance the load
+    const size_t deferBelow =
+        std::max(MIN_PARALLEL_PRIMITIVES, m_primitives.size() / (4 * std::max<size_t>(pool.getThreadCount(), 1)));
+    std::vector<Range> deferred;
+    buildNode(m_nodes, Range{0, 0, static_cast<uint32_t>(m_primitives.size()), 0}, deferBelow, &deferred);
+
+    // ranges are disjoint, each subtree partitions its own part of m_primitives
+    std::vector<std::future<std::vector<Node>>> subtrees;
+    subtrees.reserve(deferred.size());
+    for (const Range& range : deferred) {
+        subtrees.push_back(pool.submit([this, range]() {
+            std::vector<Node> nodes(1);
+            buildNode(nodes, Range{0, range.begin, range.end, range.depth}, 0, nullptr);
+            return nodes;
+        }));
+    }
+    // every subtree must be done before one rethrows, they reference this
+    for (std::future<std::vector<Node>>& subtree : subtrees)
+        subtree.wait();
+    for (size_t i = 0; i < deferred.size(); i++)
+        graft(deferred[i].node, subtrees[i].get());
+    m_centers = std::vector<glm::vec3>();
+}
+
+void Bvh::refit(const std::vector<Aabb>& bounds) {
+    if (bounds.size() != m_bounds.size())
+        throw std::runtime_error("ERROR::BVH::REFIT_PRIMITIVE_COUNT_CHANGED");
+    m_bounds = bounds;
+    refitNodes();
+}
+
+// -- Queries --
+size_t Bvh::cull(const Frustum& frustum, VisibleList& visible) const {
+    uint32_t* out = visible.prepare(m_primitives.size());
+    size_t n = 0;
+    if (m_nodes.empty()) {
+        visible.setSize(0);
+        return 0;
+    }
+
+    struct Entry {
+        uint32_t node;
+        uint32_t mask; // planes the node may still cross
+    };
+    Entry stack[MAX_DEPTH + 2];
+    size_t stackSize = 0;
+    stack[stackSize++] = {0, ALL_PLANES};
+
+    while (stackSize != 0) {
+        Entry entry = stack[--stackSize];
+        const Node& node = m_nodes[entry.node];
+
+        Containment containment = classify(frustum, node.min, node.max, entry.mask);
+        if (containment == Containment::OUTSIDE)
+            continue;
+
+        if (containment == Containment::INSIDE) {
+            // the subtree primitives are contiguous, from its leftmost leaf to its rightmost one
+            const Node* left = &node;
+            while (!left->isLeaf())
+                left = &m_nodes[left->first];
+            const Node* right = &node;
+            while (!right->isLeaf())
+                right = &m_nodes[right->first + 1];
+            size_t count = right->first + right->count - left->first;
+            std::memcpy(out + n, m_primitives.data() + left->first, count * sizeof(uint32_t));
+            n += count;
+        } else if (node.isLeaf()) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                const Aabb& bounds = m_bounds[m_primitives[i]];
+                uint32_t mask = entry.mask;
+                if (classify(frustum, bounds.min, bounds.max, mask) != Containment::OUTSIDE)
+                    out[n++] = m_primitives[i];
+            }
+        } else {
+            stack[stackSize++] = {node.first + 1, entry.mask};
+            stack[stackSize++] = {node.first, entry.mask};
+        }
+    }
+    visible.setSize(n);
+    return n;
+}
+
+std::optional<RayHit> Bvh::raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const {
+    if (m_nodes.empty())
+        return std::nullopt;
+
+    // a 0 component gives an infinite slab, which the entry test handles
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    std::optional<RayHit> hit;
+    float closest = maxDistance;
+
+    struct Entry {
+        uint32_t node;
+        float entry; // where the ray enters the node
+    };
+    Entry stack[MAX_DEPTH + 2];
+    size_t stackSize = 0;
+    float rootEntry = rayEntry(origin, inverseDirection, m_nodes[0].min, m_nodes[0].max);
+    if (rootEntry <= closest)
+        stack[stackSize++] = {0, rootEntry};
+
+    while (stackSize != 0) {
+        Entry entry = stack[--stackSize];
+        if (entry.entry > closest)
+            continue; // a closer hit was found since it was pushed
+        const Node& node = m_nodes[entry.node];
+
+        if (node.isLeaf()) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                const Aabb& bounds = m_bounds[m_primitives[i]];
+                float distance = rayEntry(origin, inverseDirection, bounds.min, bounds.max);
+                if (distance <= closest) {
+                    closest = distance;
+                    hit = RayHit{m_primitives[i], distance};
+                }
+            }
+            continue;
+        }
+
+        // the nearest child is popped first, so it can prune the other one
+        Entry left{node.first, rayEntry(origin, inverseDirection, m_nodes[node.first].min, m_nodes[node.first].max)};
+        Entry right{node.first + 1,
+                    rayEntry(origin, inverseDirection, m_nodes[node.first + 1].min, m_nodes[node.first + 1].max)};
+        if (left.entry > right.entry)
+            std::swap(left, right);
+        if (right.entry <= closest)
+            stack[stackSize++] = right;
+        if (left.entry <= closest)
+            stack[stackSize++] = left;
+    }
+    return hit;
+}
+
+// -- Private methods --
+bool Bvh::reset(std::vector<Aabb> bounds) {
+    m_bounds = std::move(bounds);
+    m_primitives.resize(m_bounds.size());
+    m_centers.resize(m_bounds.size());
+    for (size_t i = 0; i < m_bounds.size(); i++) {
+        m_primitives[i] = static_cast<uint32_t>(i);
+        m_centers[i] = m_bounds[i].getCenter();
+    }
+
+    m_nodes.clear();
+    if (m_bounds.empty())
+        return false;
+    m_nodes.push_back(Node());
+    return true;
+}
+
+void Bvh::buildNode(std::vector<Node>& nodes, Range range, size_t deferBelow, std::vector<Range>* deferred) {
+    Aabb bounds, centroids;
+    for (uint32_t i = range.begin; i < range.end; i++) {
+        bounds.grow(m_bounds[m_primitives[i]]);
+        centroids.grow(m_centers[m_primitives[i]]);
+    }
+    const uint32_t count = range.end - range.begin;
+    nodes[range.node].min = bounds.min;
+    nodes[range.node].max = bounds.max;
+    nodes[range.node].first = range.begin;
+    nodes[range.node].count = count;
+
+    if (deferred != nullptr && count <= deferBelow && range.node != 0) {
+        deferred->push_back(range);
+        return;
+    }
+    if (count == 1 || range.depth == MAX_DEPTH)
+        return;
+
+    // centroids binned on the 3 axes in one pass, an axis where they are all
+    // equal keeps them in its first bin and offers no split. Small ranges
+    // use fewer bins, the sweeps would cost more than the binning
+    struct Bin {
+        Aabb bounds;
+        uint32_t count = 0;
+    };
+    Bin bins[3][BIN_COUNT];
+    const size_t binCount = std::min<size_t>(BIN_COUNT, count);
+    glm::vec3 scales;
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = centroids.max[axis] - centroids.min[axis];
+        scales[axis] = extent > 0.0f ? binCount / extent : 0.0f;
+    }
+    auto binOf = [&](const glm::vec3& center, int axis) {
+        return std::min(binCount - 1, static_cast<size_t>((center[axis] - centroids.min[axis]) * scales[axis]));
+    };
+    for (uint32_t i = range.begin; i < range.end; i++) {
+        const uint32_t primitive = m_primitives[i];
+        for (int axis = 0; axis < 3; axis++) {
+            Bin& bin = bins[axis][binOf(m_centers[primitive], axis)];
+            bin.bounds.grow(m_bounds[primitive]);
+            bin.count++;
+        }
+    }
+
+    // cheapest split, cost is area * primitives
+    int bestAxis = -1;
+    size_t bestSplit = 0; // bins up to bestSplit go left
+    float bestCost = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; axis++) {
+        if (scales[axis] == 0.0f)
+            continue;
+        // right side costs swept from the end, then the left side from the start
+        float rightCosts[BIN_COUNT];
+        Aabb right;
+        uint32_t rightCount = 0;
+        for (size_t split = binCount - 1; split > 0; split--) {
+            right.grow(bins[axis][split].bounds);
+            rightCount += bins[axis][split].count;
+            rightCosts[split - 1] = rightCount == 0 ? 0.0f : right.getHalfArea() * rightCount;
+        }
+        Aabb left;
+        uint32_t leftCount = 0;
+        for (size_t split = 0; split + 1 < binCount; split++) {
+            left.grow(bins[axis][split].bounds);
+            leftCount += bins[axis][split].count;
+            if (leftCount == 0 || leftCount == count)
+                continue;
+            float cost = left.getHalfArea() * leftCount + rightCosts[split];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    uint32_t middle;
+    if (bestAxis < 0) {
+        // every centroid is the same point, the SAH cannot separate them
+        if (count <= MAX_LEAF_SIZE)
+            return;
+        middle = range.begin + count / 2;
+    } else {
+        // testing a leaf costs its primitives, a split costs a node test more
+        float area = bounds.getHalfArea();
+        if (count <= MAX_LEAF_SIZE && bestCost + TRAVERSAL_COST * area >= area * count)
+            return;
+        auto* split = std::partition(m_primitives.data() + range.begin, m_primitives.data() + range.end,
+                                     [&](uint32_t primitive) { return binOf(m_centers[primitive], bestAxis) <= bestSplit; });
+        middle = static_cast<uint32_t>(split - m_primitives.data());
+    }
+
+    const uint32_t leftChild = static_cast<uint32_t>(nodes.size());
+    nodes[range.node].first = leftChild;
+    nodes[range.node].count = 0;
+    nodes.resize(nodes.size() + 2);
+    buildNode(nodes, Range{leftChild, range.begin, middle, range.depth + 1}, deferBelow, deferred);
+    buildNode(nodes, Range{leftChild + 1, middle, range.end, range.depth + 1}, deferBelow, deferred);
+}
+
+void Bvh::graft(uint32_t node, const std::vector<Node>& nodes) {
+    // local child i lands at offset + i - 1, the root replaces `node`
+    const uint32_t offset = static_cast<uint32_t>(m_nodes.size());
+    auto relocate = [offset](Node copy) {
+        if (!copy.isLeaf())
+            copy.first = offset + copy.first - 1;
+        return copy;
+    };
+    m_nodes[node] = relocate(nodes[0]);
+    for (size_t i = 1; i < nodes.size(); i++)
+        m_nodes.push_back(relocate(nodes[i]));
+}
+
+void Bvh::refitNodes() {
+    // children come after their parent, a backward pass sees them first
+    for (size_t i = m_nodes.size(); i-- > 0;) {
+        Node& node = m_nodes[i];
+        Aabb bounds;
+        if (node.isLeaf()) {
+            for (uint32_t p = node.first; p < node.first + node.count; p++)
+                bounds.grow(m_bounds[m_primitives[p]]);
+        } else {
+            bounds.grow(Aabb{m_nodes[node.first].min, m_nodes[node.first].max});
+            bounds.grow(Aabb{m_nodes[node.first + 1].min, m_nodes[node.first + 1].max});
+        }
+        node.min = bounds.min;
+        node.max = bounds.max;
+    }
+}
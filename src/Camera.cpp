@@ -2,6 +2,11 @@
 
 #include "gl_utils.hpp"
 
+//== MARK: Camera Class ==//
+
+// -- Culling --
+Frustum Camera::getFrustum()const{return Frustum::fromMatrix(getProjectionViewMat());}
+
 //== MARK: StaticPerspectiveCamera Class ==//
 
 
@@ -0,0 +1,72 @@
+#include "CommandList.hpp"
+
+#include "GlState.hpp"
+#include "Program.hpp"
+#include "VertexArray.hpp"
+#include "gl_utils.hpp"
+
+// -- Private utils --
+
+namespace {
+
+template <typename C>
+const C& commandAt(const std::byte* bytes, size_t offset) {
+    return *std::launder(reinterpret_cast<const C*>(bytes + offset));
+}
+
+} // namespace
+
+// -- Replay --
+void CommandList::replay(RenderQueue& queue) const {
+    constexpr size_t COMMAND_OFFSET = align(sizeof(CommandHeader));
+
+    const std::byte* bytes = m_data.get();
+    for (size_t offset = 0; offset < m_size;) {
+        const CommandHeader& header = commandAt<CommandHeader>(bytes, offset);
+        const size_t commandOffset = offset + COMMAND_OFFSET;
+
+        switch (header.type) {
+            case CommandType::USE_PROGRAM:
+                commandAt<UseProgramCommand>(bytes, commandOffset).program->useProgram();
+                break;
+
+            case CommandType::BIND_TEXTURE: {
+                const auto& command = commandAt<BindTextureCommand>(bytes, commandOffset);
+                GlState::bindTexture(command.unit, command.target, command.texture);
+                break;
+            }
+
+            case CommandType::SET_UNIFORM_BLOCK: {
+                const auto& command = commandAt<SetUniformBlockCommand>(bytes, commandOffset);
+                const std::byte* payload = bytes + commandOffset + align(sizeof(SetUniformBlockCommand));
+                // binding the indexed point binds the generic one too
+                GlState::bindBufferBase(GL_UNIFORM_BUFFER, command.bindingPoint, command.buffer);
+                glCall(glBufferSubData(GL_UNIFORM_BUFFER, 0, command.size, payload));
+                break;
+            }
+
+            case CommandType::UPLOAD_BUFFER: {
+                const auto& command = commandAt<UploadBufferCommand>(bytes, commandOffset);
+                const std::byte* payload = bytes + commandOffset + align(sizeof(UploadBufferCommand));
+                // the copy target leaves the VAO element binding alone
+                GlState::bindBuffer(GL_COPY_WRITE_BUFFER, command.buffer);
+                glCall(glBufferSubData(GL_COPY_WRITE_BUFFER, command.offset, command.size, payload));
+                break;
+            }
+
+            case CommandType::DRAW: {
+                const auto& command = commandAt<DrawCommand>(bytes, commandOffset);
+                if (command.instanceCount > 0)
+                    command.vertexArray->drawInstanced(command.instanceCount, command.mode);
+                else
+                    command.vertexArray->draw(command.mode);
+                break;
+            }
+
+            case CommandType::SUBMIT:
+                queue.submit(commandAt<SubmitCommand>(bytes, commandOffset).submission);
+                break;
+        }
+        offset += header.size;
+    }
+}
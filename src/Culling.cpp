@@ -0,0 +1,353 @@
+#include "Culling.hpp"
+
+#include <bit>
+#include <cmath>
+
+#if defined(CULLING_AVX)
+#include <immintrin.h>
+#elif defined(CULLING_SSE)
+#include <emmintrin.h>
+#endif
+
+// -- Private utils --
+
+namespace {
+
+// grouped as the SIMD paths do, so every path keeps the same volumes
+float planeDistance(const glm::vec4& plane, float x, float y, float z) {
+    return (plane.x * x + plane.y * y) + (plane.z * z + plane.w);
+}
+
+// Scalar culling of [begin, end), written from out[n], @returns the new n
+size_t cullSpheresRange(const Frustum& frustum, const BoundingSpheres& spheres, size_t begin, size_t end,
+                        uint32_t* out, size_t n) {
+    const float *x = spheres.getX(), *y = spheres.getY(), *z = spheres.getZ(), *radius = spheres.getRadius();
+    for (size_t i = begin; i < end; i++) {
+        bool inside = true;
+        for (const glm::vec4& plane : frustum.planes)
+            inside &= planeDistance(plane, x[i], y[i], z[i]) + radius[i] >= 0.0f;
+        out[n] = static_cast<uint32_t>(i);
+        n += inside;
+    }
+    return n;
+}
+
+size_t cullBoxesRange(const Frustum& frustum, const BoundingBoxes& boxes, size_t begin, size_t end, uint32_t* out,
+                      size_t n) {
+    const float *x = boxes.getX(), *y = boxes.getY(), *z = boxes.getZ();
+    const float *ex = boxes.getExtentX(), *ey = boxes.getExtentY(), *ez = boxes.getExtentZ();
+    for (size_t i = begin; i < end; i++) {
+        bool inside = true;
+        for (const glm::vec4& plane : frustum.planes) {
+            // half extents projected on the normal, the box is a sphere of that radius
+            float reach = (std::abs(plane.x) * ex[i] + std::abs(plane.y) * ey[i]) + std::abs(plane.z) * ez[i];
+            inside &= planeDistance(plane, x[i], y[i], z[i]) + reach >= 0.0f;
+        }
+        out[n] = static_cast<uint32_t>(i);
+        n += inside;
+    }
+    return n;
+}
+
+#if defined(CULLING_AVX) || defined(CULLING_SSE)
+
+// Lane offsets of the set bits of a 4 bit mask, packed first
+struct CompactTable {
+    alignas(16) uint32_t lanes[16][4];
+
+    constexpr CompactTable() : lanes() {
+        for (uint32_t mask = 0; mask < 16; mask++) {
+            uint32_t n = 0;
+            for (uint32_t lane = 0; lane < 4; lane++)
+                if (mask & (1u << lane))
+                    lanes[mask][n++] = lane;
+        }
+    }
+};
+constexpr CompactTable COMPACT_TABLE;
+
+// Writes base + the offsets of the set lanes of `mask` at out[n], always
+// storing 4 indices, @returns the new n
+inline size_t compact4(uint32_t* out, size_t n, uint32_t base, unsigned mask) {
+    __m128i lanes = _mm_load_si128(reinterpret_cast<const __m128i*>(COMPACT_TABLE.lanes[mask]));
+    __m128i indices = _mm_add_epi32(lanes, _mm_set1_epi32(static_cast<int>(base)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n), indices);
+    return n + std::popcount(mask);
+}
+
+// The few operations the culling needs, on the widest float register
+#if defined(CULLING_AVX)
+struct Lanes {
+    using Float = __m256;
+    static constexpr size_t COUNT = 8;
+
+    static Float set1(float value) { return _mm256_set1_ps(value); }
+    static Float load(const float* values) { return _mm256_loadu_ps(values); }
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    static Float both(Float a, Float b) { return _mm256_and_ps(a, b); }
+    // a + b >= 0 on every lane, as a lane mask
+    static Float nonNegativeSum(Float a, Float b) {
+        return _mm256_cmp_ps(_mm256_add_ps(a, b), _mm256_setzero_ps(), _CMP_GE_OQ);
+    }
+    static unsigned mask(Float lanes) { return static_cast<unsigned>(_mm256_movemask_ps(lanes)); }
+
+    static size_t compact(uint32_t* out, size_t n, uint32_t base, unsigned mask) {
+        n = compact4(out, n, base, mask & 0xF);
+        return compact4(out, n, base + 4, mask >> 4);
+    }
+};
+#else
+struct Lanes {
+    using Float = __m128;
+    static constexpr size_t COUNT = 4;
+
+    static Float set1(float value) { return _mm_set1_ps(value); }
+    static Float load(const float* values) { return _mm_loadu_ps(values); }
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+    static Float both(Float a, Float b) { return _mm_and_ps(a, b); }
+    static Float nonNegativeSum(Float a, Float b) { return _mm_cmpge_ps(_mm_add_ps(a, b), _mm_setzero_ps()); }
+    static unsigned mask(Float lanes) { return static_cast<unsigned>(_mm_movemask_ps(lanes)); }
+
+    static size_t compact(uint32_t* out, size_t n, uint32_t base, unsigned mask) {
+        return compact4(out, n, base, mask);
+    }
+};
+#endif
+
+// Planes broadcast once per call
+struct LanePlanes {
+    Lanes::Float a[Frustum::PLANE_COUNT], b[Frustum::PLANE_COUNT], c[Frustum::PLANE_COUNT], d[Frustum::PLANE_COUNT];
+    Lanes::Float absA[Frustum::PLANE_COUNT], absB[Frustum::PLANE_COUNT], absC[Frustum::PLANE_COUNT];
+
+    explicit LanePlanes(const Frustum& frustum) {
+        for (size_t p = 0; p < Frustum::PLANE_COUNT; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            a[p] = Lanes::set1(plane.x);
+            b[p] = Lanes::set1(plane.y);
+            c[p] = Lanes::set1(plane.z);
+            d[p] = Lanes::set1(plane.w);
+            absA[p] = Lanes::set1(std::abs(plane.x));
+            absB[p] = Lanes::set1(std::abs(plane.y));
+            absC[p] = Lanes::set1(std::abs(plane.z));
+        }
+    }
+
+    Lanes::Float distance(size_t p, Lanes::Float x, Lanes::Float y, Lanes::Float z) const {
+        return Lanes::add(Lanes::add(Lanes::mul(a[p], x), Lanes::mul(b[p], y)), Lanes::add(Lanes::mul(c[p], z), d[p]));
+    }
+};
+
+size_t cullSpheresLanes(const Frustum& frustum, const BoundingSpheres& spheres, VisibleList& visible) {
+    const size_t count = spheres.size();
+    const size_t blockEnd = count - count % Lanes::COUNT;
+    // the last compact may store a full block past the visible indices
+    uint32_t* out = visible.prepare(count + Lanes::COUNT);
+
+    const LanePlanes planes(frustum);
+    const float *x = spheres.getX(), *y = spheres.getY(), *z = spheres.getZ(), *radius = spheres.getRadius();
+    size_t n = 0;
+    for (size_t i = 0; i < blockEnd; i += Lanes::COUNT) {
+        Lanes::Float cx = Lanes::load(x + i), cy = Lanes::load(y + i), cz = Lanes::load(z + i);
+        Lanes::Float r = Lanes::load(radius + i);
+
+        Lanes::Float inside = Lanes::nonNegativeSum(planes.distance(0, cx, cy, cz), r);
+        for (size_t p = 1; p < Frustum::PLANE_COUNT; p++)
+            inside = Lanes::both(inside, Lanes::nonNegativeSum(planes.distance(p, cx, cy, cz), r));
+        n = Lanes::compact(out, n, static_cast<uint32_t>(i), Lanes::mask(inside));
+    }
+    n = cullSpheresRange(frustum, spheres, blockEnd, count, out, n);
+    visible.setSize(n);
+    return n;
+}
+
+size_t cullBoxesLanes(const Frustum& frustum, const BoundingBoxes& boxes, VisibleList& visible) {
+    const size_t count = boxes.size();
+    const size_t blockEnd = count - count % Lanes::COUNT;
+    uint32_t* out = visible.prepare(count + Lanes::COUNT);
+
+    const LanePlanes planes(frustum);
+    const float *x = boxes.getX(), *y = boxes.getY(), *z = boxes.getZ();
+    const float *extentX = boxes.getExtentX(), *extentY = boxes.getExtentY(), *extentZ = boxes.getExtentZ();
+    size_t n = 0;
+    for (size_t i = 0; i < blockEnd; i += Lanes::COUNT) {
+        Lanes::Float cx = Lanes::load(x + i), cy = Lanes::load(y + i), cz = Lanes::load(z + i);
+        Lanes::Float ex = Lanes::load(extentX + i), ey = Lanes::load(extentY + i), ez = Lanes::load(extentZ + i);
+
+        auto planeInside = [&](size_t p) {
+            Lanes::Float reach = Lanes::add(Lanes::add(Lanes::mul(planes.absA[p], ex), Lanes::mul(planes.absB[p], ey)),
+                                            Lanes::mul(planes.absC[p], ez));
+            return Lanes::nonNegativeSum(planes.distance(p, cx, cy, cz), reach);
+        };
+        Lanes::Float inside = planeInside(0);
+        for (size_t p = 1; p < Frustum::PLANE_COUNT; p++)
+            inside = Lanes::both(inside, planeInside(p));
+        n = Lanes::compact(out, n, static_cast<uint32_t>(i), Lanes::mask(inside));
+    }
+    n = cullBoxesRange(frustum, boxes, blockEnd, count, out, n);
+    visible.setSize(n);
+    return n;
+}
+
+#endif
+
+} // namespace
+
+// -- Frustum --
+Frustum Frustum::fromMatrix(const glm::mat4& projectionView) {
+    // glm is column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&projectionView](int i) {
+        return glm::vec4(projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i]);
+    };
+    const glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+
+    // clip space is -w <= x, y, z <= w
+    Frustum frustum;
+    frustum.planes[PLANE_LEFT] = w + x;
+    frustum.planes[PLANE_RIGHT] = w - x;
+    frustum.planes[PLANE_BOTTOM] = w + y;
+    frustum.planes[PLANE_TOP] = w - y;
+    frustum.planes[PLANE_NEAR] = w + z;
+    frustum.planes[PLANE_FAR] = w - z;
+    for (glm::vec4& plane : frustum.planes)
+        plane /= glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+bool Frustum::intersectsSphere(glm::vec3 center, float radius) const {
+    for (const glm::vec4& plane : planes)
+        if (planeDistance(plane, center.x, center.y, center.z) < -radius)
+            return false;
+    return true;
+}
+
+bool Frustum::intersectsAabb(glm::vec3 min, glm::vec3 max) const {
+    for (const glm::vec4& plane : planes) {
+        // the corner furthest along the normal
+        float x = plane.x >= 0.0f ? max.x : min.x;
+        float y = plane.y >= 0.0f ? max.y : min.y;
+        float z = plane.z >= 0.0f ? max.z : min.z;
+        if (planeDistance(plane, x, y, z) < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+// -- BoundingSpheres --
+void BoundingSpheres::push(glm::vec3 center, float radius) {
+    m_x.push_back(center.x);
+    m_y.push_back(center.y);
+    m_z.push_back(center.z);
+    m_radius.push_back(radius);
+}
+
+void BoundingSpheres::set(size_t index, glm::vec3 center, float radius) {
+    m_x[index] = center.x;
+    m_y[index] = center.y;
+    m_z[index] = center.z;
+    m_radius[index] = radius;
+}
+
+void BoundingSpheres::reserve(size_t count) {
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_z.reserve(count);
+    m_radius.reserve(count);
+}
+
+void BoundingSpheres::clear() {
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_radius.clear();
+}
+
+// -- BoundingBoxes --
+void BoundingBoxes::push(glm::vec3 min, glm::vec3 max) {
+    m_x.push_back(0.0f);
+    m_y.push_back(0.0f);
+    m_z.push_back(0.0f);
+    m_extentX.push_back(0.0f);
+    m_extentY.push_back(0.0f);
+    m_extentZ.push_back(0.0f);
+    set(m_x.size() - 1, min, max);
+}
+
+void BoundingBoxes::set(size_t index, glm::vec3 min, glm::vec3 max) {
+    glm::vec3 center = (min + max) * 0.5f;
+    glm::vec3 extent = (max - min) * 0.5f;
+    m_x[index] = center.x;
+    m_y[index] = center.y;
+    m_z[index] = center.z;
+    m_extentX[index] = extent.x;
+    m_extentY[index] = extent.y;
+    m_extentZ[index] = extent.z;
+}
+
+void BoundingBoxes::reserve(size_t count) {
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_z.reserve(count);
+    m_extentX.reserve(count);
+    m_extentY.reserve(count);
+    m_extentZ.reserve(count);
+}
+
+void BoundingBoxes::clear() {
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_extentX.clear();
+    m_extentY.clear();
+    m_extentZ.clear();
+}
+
+// -- VisibleList --
+uint32_t* VisibleList::prepare(size_t capacity) {
+    if (capacity > m_capacity) {
+        m_indices.reset(new uint32_t[capacity]);
+        m_capacity = capacity;
+    }
+    m_size = 0;
+    return m_indices.get();
+}
+
+// -- Culling --
+size_t cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, VisibleList& visible) {
+#if defined(CULLING_AVX) || defined(CULLING_SSE)
+    return cullSpheresLanes(frustum, spheres, visible);
+#else
+    return cullSpheresScalar(frustum, spheres, visible);
+#endif
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, VisibleList& visible) {
+#if defined(CULLING_AVX) || defined(CULLING_SSE)
+    return cullBoxesLanes(frustum, boxes, visible);
+#else
+    return cullBoxesScalar(frustum, boxes, visible);
+#endif
+}
+
+size_t cullSpheresScalar(const Frustum& frustum, const BoundingSpheres& spheres, VisibleList& visible) {
+    size_t n = cullSpheresRange(frustum, spheres, 0, spheres.size(), visible.prepare(spheres.size()), 0);
+    visible.setSize(n);
+    return n;
+}
+
+size_t cullBoxesScalar(const Frustum& frustum, const BoundingBoxes& boxes, VisibleList& visible) {
+    size_t n = cullBoxesRange(frustum, boxes, 0, boxes.size(), visible.prepare(boxes.size()), 0);
+    visible.setSize(n);
+    return n;
+}
+
+const char* cullingPath() {
+#if defined(CULLING_AVX)
+    return "AVX";
+#elif defined(CULLING_SSE)
+    return "SSE";
+#else
+    return "scalar";
+#endif
+}
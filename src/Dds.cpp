@@ -0,0 +1,151 @@
+#include "Dds.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "gl_utils.hpp"
+
+// -- Private utils --
+
+namespace {
+
+// layout from the DirectX documentation, "DDS_HEADER structure"
+struct DdsPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t rgbBitCount;
+    uint32_t rBitMask;
+    uint32_t gBitMask;
+    uint32_t bBitMask;
+    uint32_t aBitMask;
+};
+
+struct DdsHeader {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitchOrLinearSize;
+    uint32_t depth;
+    uint32_t mipMapCount;
+    uint32_t reserved1[11];
+    DdsPixelFormat pixelFormat;
+    uint32_t caps;
+    uint32_t caps2;
+    uint32_t caps3;
+    uint32_t caps4;
+    uint32_t reserved2;
+};
+
+static_assert(sizeof(DdsPixelFormat) == 32);
+static_assert(sizeof(DdsHeader) == 124);
+
+constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+constexpr uint32_t DDSD_CAPS = 0x1;
+constexpr uint32_t DDSD_HEIGHT = 0x2;
+constexpr uint32_t DDSD_WIDTH = 0x4;
+constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+constexpr uint32_t DDSD_LINEARSIZE = 0x80000;
+
+constexpr uint32_t DDPF_FOURCC = 0x4;
+
+constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+constexpr uint32_t DDSCAPS_MIPMAP = 0x400000;
+
+constexpr uint32_t fourCC(const char (&code)[5]) {
+    return uint32_t(code[0]) | uint32_t(code[1]) << 8 | uint32_t(code[2]) << 16 | uint32_t(code[3]) << 24;
+}
+
+GLenum formatFromFourCC(uint32_t code) {
+    switch (code) {
+        case fourCC("DXT1"): return GL_COMPRESSED_RGB_S3TC_DXT1_EXT; // no 1 bit alpha
+        case fourCC("DXT3"): return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        case fourCC("DXT5"): return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        default:             return 0;
+    }
+}
+
+uint32_t fourCCFromFormat(GLenum internalFormat) {
+    switch (internalFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return fourCC("DXT1");
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: return fourCC("DXT3");
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return fourCC("DXT5");
+        default: throw std::runtime_error("ERROR::DDS::UNSUPPORTED_FORMAT");
+    }
+}
+
+} // namespace
+
+// -- Constructors --
+DdsFile::DdsFile(const char* path) : m_file(path), m_internalFormat(0), m_levels() {
+    if (m_file.size() < sizeof(uint32_t) + sizeof(DdsHeader))
+        throw std::runtime_error(std::string("ERROR::DDS::TRUNCATED ") + path);
+
+    uint32_t magic;
+    DdsHeader header;
+    std::memcpy(&magic, m_file.data(), sizeof(magic));
+    std::memcpy(&header, m_file.data() + sizeof(magic), sizeof(header));
+
+    if (magic != DDS_MAGIC || header.size != sizeof(DdsHeader))
+        throw std::runtime_error(std::string("ERROR::DDS::BAD_HEADER ") + path);
+    if (!(header.pixelFormat.flags & DDPF_FOURCC) ||
+        (m_internalFormat = formatFromFourCC(header.pixelFormat.fourCC)) == 0)
+        throw std::runtime_error(std::string("ERROR::DDS::UNSUPPORTED_FORMAT ") + path);
+
+    const uint32_t levelCount = (header.flags & DDSD_MIPMAPCOUNT) ? std::max(header.mipMapCount, 1u) : 1;
+
+    size_t offset = sizeof(magic) + sizeof(DdsHeader);
+    size_t width = header.width, height = header.height;
+    for (uint32_t level = 0; level < levelCount; level++) {
+        size_t size = glCompressedImageSize(m_internalFormat, width, height);
+        if (offset + size > m_file.size())
+            throw std::runtime_error(std::string("ERROR::DDS::TRUNCATED ") + path);
+
+        m_levels.push_back({reinterpret_cast<const unsigned char*>(m_file.data() + offset),
+                            static_cast<GLsizei>(size), static_cast<GLsizei>(width),
+                            static_cast<GLsizei>(height)});
+
+        offset += size;
+        width = std::max<size_t>(width / 2, 1);
+        height = std::max<size_t>(height / 2, 1);
+    }
+}
+
+// -- Writing --
+void writeDds(const char* path, GLenum internalFormat, GLsizei width, GLsizei height,
+              const std::vector<std::vector<unsigned char>>& levels) {
+    uint32_t magic = DDS_MAGIC;
+
+    DdsHeader header = {};
+    header.size = sizeof(DdsHeader);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    header.height = height;
+    header.width = width;
+    header.pitchOrLinearSize = static_cast<uint32_t>(levels.front().size());
+    header.mipMapCount = static_cast<uint32_t>(levels.size());
+    header.pixelFormat.size = sizeof(DdsPixelFormat);
+    header.pixelFormat.flags = DDPF_FOURCC;
+    header.pixelFormat.fourCC = fourCCFromFormat(internalFormat);
+    header.caps = DDSCAPS_TEXTURE | (levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error(std::string("ERROR::DDS::OPEN_FAILED ") + path);
+
+    file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const std::vector<unsigned char>& level : levels)
+        file.write(reinterpret_cast<const char*>(level.data()), level.size());
+
+    if (!file)
+        throw std::runtime_error(std::string("ERROR::DDS::WRITE_FAILED ") + path);
+}
@@ -0,0 +1,109 @@
+#include "Framebuffer.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "GlDebug.hpp"
+#include "gl_utils.hpp"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+// -- Constructors --
+Framebuffer::Framebuffer(GLsizei width, GLsizei height)
+    : m_glId(0), m_colorId(0), m_depthId(0), m_width(width), m_height(height) {
+    glCall(glGenRenderbuffers(1, &m_colorId));
+    glCall(glBindRenderbuffer(GL_RENDERBUFFER, m_colorId));
+    glCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+
+    glCall(glGenRenderbuffers(1, &m_depthId));
+    glCall(glBindRenderbuffer(GL_RENDERBUFFER, m_depthId));
+    glCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height));
+    glCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+    glCall(glGenFramebuffers(1, &m_glId));
+    glCall(glBindFramebuffer(GL_FRAMEBUFFER, m_glId));
+    glCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorId));
+    glCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthId));
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        release();
+        throw std::runtime_error("ERROR::FRAMEBUFFER::INCOMPLETE " + std::to_string(status));
+    }
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+    : m_glId(other.m_glId),
+      m_colorId(other.m_colorId),
+      m_depthId(other.m_depthId),
+      m_width(other.m_width),
+      m_height(other.m_height) {
+    other.m_glId = 0;
+    other.m_colorId = 0;
+    other.m_depthId = 0;
+}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_glId = other.m_glId;
+        m_colorId = other.m_colorId;
+        m_depthId = other.m_depthId;
+        m_width = other.m_width;
+        m_height = other.m_height;
+        other.m_glId = 0;
+        other.m_colorId = 0;
+        other.m_depthId = 0;
+    }
+    return *this;
+}
+
+// -- Destructor --
+Framebuffer::~Framebuffer() {
+    release();
+}
+
+// -- Methods --
+void Framebuffer::bind() const {
+    glCall(glBindFramebuffer(GL_FRAMEBUFFER, m_glId));
+    glCall(glViewport(0, 0, m_width, m_height));
+}
+
+void Framebuffer::unbind() const {
+    glCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::readPixels(std::vector<unsigned char>& pixels) const {
+    pixels.resize(size_t(m_width) * m_height * 4);
+    glCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_glId));
+    glCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+    glCall(glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+}
+
+void Framebuffer::writePng(const char* path) const {
+    std::vector<unsigned char> pixels;
+    readPixels(pixels);
+
+    stbi_flip_vertically_on_write(1);
+    if (!stbi_write_png(path, m_width, m_height, 4, pixels.data(), m_width * 4))
+        throw std::runtime_error(std::string("ERROR::FRAMEBUFFER::CANNOT_WRITE_PNG ") + path);
+}
+
+void Framebuffer::setLabel(std::string_view label) const {
+    GlDebugOutput::label(GL_FRAMEBUFFER, m_glId, label);
+}
+
+// -- Private methods --
+void Framebuffer::release() {
+    if (m_glId != 0)
+        glDeleteFramebuffers(1, &m_glId);
+    if (m_colorId != 0)
+        glDeleteRenderbuffers(1, &m_colorId);
+    if (m_depthId != 0)
+        glDeleteRenderbuffers(1, &m_depthId);
+    m_glId = 0;
+    m_colorId = 0;
+    m_depthId = 0;
+}
@@ -1,10 +1,15 @@
 #include "GlBuffer.hpp"
 
+#include <stdexcept>
+
+#include "GlDebug.hpp"
+#include "GlState.hpp"
+#include "Movable.hpp"
 #include "gl_utils.hpp"
 
 //-- Constructors --
 template <typename T,const GLenum BufferType>
-GlBuffer<T,BufferType>::GlBuffer(){
+GlBuffer<T,BufferType>::GlBuffer(): m_count(0){
     glCall(glGenBuffers(1,&m_glId));
 }
 template <typename T,const GLenum BufferType>
@@ -17,17 +22,22 @@ GlBuffer<T,BufferType>::GlBuffer(const T* data,size_t size):
 {}
 template <typename T,const GLenum BufferType>
 GlBuffer<T,BufferType>::GlBuffer(GlBuffer&& rvalue):
-    m_glId(rvalue.m_glId)
+    m_glId(rvalue.m_glId),
+    m_count(rvalue.m_count)
 {
     rvalue.m_glId = 0;
+    rvalue.m_count = 0;
 }
 
 template <typename T,const GLenum BufferType>
 GlBuffer<T,BufferType>& GlBuffer<T,BufferType>::operator=(GlBuffer<T,BufferType>&& other) noexcept{
     if (this != &other) {
         glDeleteBuffers(1, &m_glId);
+        GlState::forgetBuffer(m_glId);
         m_glId = other.m_glId;
+        m_count = other.m_count;
         other.m_glId = 0;
+        other.m_count = 0;
     }
     return *this;
 }
@@ -36,6 +46,7 @@ GlBuffer<T,BufferType>& GlBuffer<T,BufferType>::operator=(GlBuffer<T,BufferType>
 template <typename T,const GLenum BufferType>
 GlBuffer<T,BufferType>::~GlBuffer(){
     glDeleteBuffers(1,&m_glId);
+    GlState::forgetBuffer(m_glId);
 }
 
 //-- Methods --
@@ -43,17 +54,54 @@ template <typename T,const GLenum BufferType>
 void GlBuffer<T,BufferType>::uploadData(const T* data,size_t count, GLenum usage){
     bind();
     glCall(glBufferData(BufferType,count * sizeof(T),data, usage));
+    m_count = count;
+}
+template <typename T,const GLenum BufferType>
+void GlBuffer<T,BufferType>::uploadSubData(const T* data,size_t count, size_t offset){
+    bind();
+    glCall(glBufferSubData(BufferType,offset * sizeof(T),count * sizeof(T),data));
+}
+template <typename T,const GLenum BufferType>
+T* GlBuffer<T,BufferType>::mapRange(size_t offset,size_t count, GLbitfield access){
+    bind();
+    glCall(void* mapped = glMapBufferRange(BufferType,offset * sizeof(T),count * sizeof(T),access));
+    return static_cast<T*>(mapped);
+}
+template <typename T,const GLenum BufferType>
+void GlBuffer<T,BufferType>::unmap(){
+    bind();
+    // GL_FALSE means the content got corrupted (e.g. a mode switch), rare
+    // enough to be handled like any other GL failure
+    if(glUnmapBuffer(BufferType) == GL_FALSE)
+        throw std::runtime_error("ERROR::GL_BUFFER::UNMAP_FAILED the buffer content was lost");
 }
 template <typename T,const GLenum BufferType>
 void GlBuffer<T,BufferType>::bind() const{
-    glCall(glBindBuffer(BufferType,m_glId));
+    GlState::bindBuffer(BufferType,m_glId);
 }
 template <typename T,const GLenum BufferType>
 void GlBuffer<T,BufferType>::unbind() const{
-    glCall(glBindBuffer(BufferType,0));
+    GlState::bindBuffer(BufferType,0);
+}
+template <typename T,const GLenum BufferType>
+void GlBuffer<T,BufferType>::bindBase(GLuint bindingPoint) const{
+    GlState::bindBufferBase(BufferType,bindingPoint,m_glId);
+}
+template <typename T,const GLenum BufferType>
+void GlBuffer<T,BufferType>::setLabel(std::string_view label) const{
+    // glGenBuffers only reserves the name, the object exists once bound. The
+    // copy target is used so no VAO element binding is touched
+    GlState::bindBuffer(GL_COPY_WRITE_BUFFER,m_glId);
+    GlDebugOutput::label(GL_BUFFER,m_glId,label);
 }
 
 
 // -- Alias --
 template class GlBuffer<float, GL_ARRAY_BUFFER>;
-template class GlBuffer<unsigned int, GL_ELEMENT_ARRAY_BUFFER>;
+template class GlBuffer<std::byte, GL_ARRAY_BUFFER>;
+template class GlBuffer<InstanceTransform, GL_ARRAY_BUFFER>;
+template class GlBuffer<GLubyte, GL_ELEMENT_ARRAY_BUFFER>;
+template class GlBuffer<GLushort, GL_ELEMENT_ARRAY_BUFFER>;
+template class GlBuffer<GLuint, GL_ELEMENT_ARRAY_BUFFER>;
+template class GlBuffer<std::byte, GL_UNIFORM_BUFFER>;
+template class GlBuffer<GLubyte, GL_PIXEL_UNPACK_BUFFER>;
@@ -0,0 +1,269 @@
+#include "GlDebug.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "MpscRing.hpp"
+#include "gl_utils.hpp"
+
+// -- Private utils --
+
+namespace {
+
+using DebugMessageCallbackProc = void(APIENTRY*)(GLDEBUGPROC callback, const void* userParam);
+using DebugMessageControlProc = void(APIENTRY*)(GLenum source, GLenum type, GLenum severity, GLsizei count,
+                                                const GLuint* ids, GLboolean enabled);
+using ObjectLabelProc = void(APIENTRY*)(GLenum identifier, GLuint name, GLsizei length, const GLchar* label);
+
+struct Message {
+    GLenum source;
+    GLenum type;
+    GLenum severity;
+    GLuint id;
+    size_t length;
+    char text[GlDebugOutput::MAX_MESSAGE_LENGTH];
+};
+
+// The callback may come from a driver thread, it only touches the ring and
+// the atomics below
+MpscRing<Message, GlDebugOutput::RING_CAPACITY> s_messages;
+std::atomic<size_t> s_dropped(0);
+// bumped on every push, the logging thread sleeps on it
+std::atomic<uint32_t> s_posted(0);
+std::atomic<bool> s_running(false);
+
+DebugMessageControlProc s_debugMessageControl = nullptr;
+ObjectLabelProc s_objectLabel = nullptr;
+GLsizei s_maxLabelLength = 0;
+
+const char* sourceName(GLenum source) {
+    switch (source) {
+        case GL_DEBUG_SOURCE_API: return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "WINDOW_SYSTEM";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "SHADER_COMPILER";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "THIRD_PARTY";
+        case GL_DEBUG_SOURCE_APPLICATION: return "APPLICATION";
+        default: return "OTHER";
+    }
+}
+
+const char* typeName(GLenum type) {
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return "ERROR";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "DEPRECATED_BEHAVIOR";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "UNDEFINED_BEHAVIOR";
+        case GL_DEBUG_TYPE_PORTABILITY: return "PORTABILITY";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "PERFORMANCE";
+        case GL_DEBUG_TYPE_MARKER: return "MARKER";
+        default: return "OTHER";
+    }
+}
+
+const char* severityName(GLenum severity) {
+    switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH: return "HIGH";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "MEDIUM";
+        case GL_DEBUG_SEVERITY_LOW: return "LOW";
+        default: return "NOTIFICATION";
+    }
+}
+
+void printMessage(const Message& message) {
+    std::cerr << "GL DEBUG [" << severityName(message.severity) << "] " << typeName(message.type) << " from "
+              << sourceName(message.source) << " (" << message.id << ") : "
+              << std::string_view(message.text, message.length) << '\n';
+}
+
+void loggerLoop() {
+    Message message;
+    size_t reportedDrops = 0;
+    for (;;) {
+        // read before draining, a push landing after the drain changes it and
+        // wait() returns right away
+        uint32_t posted = s_posted.load(std::memory_order_acquire);
+        bool running = s_running.load(std::memory_order_acquire);
+
+        while (s_messages.tryPop(message))
+            printMessage(message);
+
+        size_t dropped = s_dropped.load(std::memory_order_relaxed);
+        if (dropped != reportedDrops) {
+            std::cerr << "GL DEBUG : " << dropped - reportedDrops << " messages dropped, the ring was full\n";
+            reportedDrops = dropped;
+        }
+        std::cerr.flush();
+
+        if (!running)
+            return;
+        s_posted.wait(posted, std::memory_order_acquire);
+    }
+}
+
+// Owns the logging thread. A run leaving through exit() (failed expect_*) or
+// an early return skips shutdown(), the thread is then joined when the
+// statics are destroyed instead of terminating the process as joinable
+class Logger
+{
+private:
+    std::thread m_thread;
+
+public:
+    ~Logger() { stop(); }
+
+    void start() {
+        s_running.store(true, std::memory_order_release);
+        m_thread = std::thread(loggerLoop);
+    }
+
+    // prints what is queued then joins
+    void stop() {
+        if (!m_thread.joinable())
+            return;
+        s_running.store(false, std::memory_order_release);
+        s_posted.fetch_add(1, std::memory_order_release);
+        s_posted.notify_one();
+        m_thread.join();
+    }
+};
+
+// after the ring, so it is destroyed first
+Logger s_logger;
+
+void APIENTRY debugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                            const GLchar* text, const void*) {
+    Message message;
+    message.source = source;
+    message.type = type;
+    message.severity = severity;
+    message.id = id;
+    // length is negative when the driver only gives a null terminated string
+    size_t textLength = length < 0 ? std::strlen(text) : static_cast<size_t>(length);
+    message.length = std::min(textLength, sizeof(message.text));
+    std::memcpy(message.text, text, message.length);
+
+    if (!s_messages.tryPush(message)) {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    s_posted.fetch_add(1, std::memory_order_release);
+    s_posted.notify_one();
+}
+
+} // namespace
+
+// -- glCall failure paths --
+void glCallAbort(GLenum error, const char* call, const char* file, int line) {
+    std::fprintf(stderr, "GL ERROR [0x%04X] in %s at :%s::%d\n", error, call, file, line);
+    std::abort();
+}
+
+void glCallThrow(GLenum error, const char* call, const char* file, int line) {
+    std::string message = "GL ERROR in ";
+    message += call;
+    message += " at :";
+    message += file;
+    message += "::";
+    message += std::to_string(line);
+    message += "\n\n";
+
+    do {
+        appendGlError(message, error);
+        error = glGetError();
+    } while (error != GL_NO_ERROR);
+
+    throw std::runtime_error(message);
+}
+
+// -- Init --
+bool GlDebugOutput::isSupported() {
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major > 4 || (major == 4 && minor >= 3))
+        return true;
+
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension != nullptr && std::strcmp(extension, "GL_KHR_debug") == 0)
+            return true;
+    }
+    return false;
+}
+
+bool GlDebugOutput::init(GLADloadproc load, GLenum minSeverity) {
+    if (isActive() || !isSupported())
+        return isActive();
+
+    auto debugMessageCallback = reinterpret_cast<DebugMessageCallbackProc>(load("glDebugMessageCallback"));
+    s_debugMessageControl = reinterpret_cast<DebugMessageControlProc>(load("glDebugMessageControl"));
+    s_objectLabel = reinterpret_cast<ObjectLabelProc>(load("glObjectLabel"));
+    if (debugMessageCallback == nullptr || s_debugMessageControl == nullptr) {
+        s_debugMessageControl = nullptr;
+        s_objectLabel = nullptr;
+        return false;
+    }
+    glGetIntegerv(GL_MAX_LABEL_LENGTH, &s_maxLabelLength);
+
+    // the thread must be there before the first message
+    s_logger.start();
+
+    glEnable(GL_DEBUG_OUTPUT);
+#if GL_CHECK_LEVEL != GL_CHECK_OFF
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+#endif
+    debugMessageCallback(debugCallback, nullptr);
+    setMinSeverity(minSeverity);
+    return true;
+}
+
+void GlDebugOutput::shutdown() {
+    if (!isActive())
+        return;
+
+    glDisable(GL_DEBUG_OUTPUT);
+    s_logger.stop();
+
+    s_debugMessageControl = nullptr;
+    s_objectLabel = nullptr;
+}
+
+// -- Getters --
+bool GlDebugOutput::isActive() {
+    return s_debugMessageControl != nullptr;
+}
+
+size_t GlDebugOutput::getDroppedCount() {
+    return s_dropped.load(std::memory_order_relaxed);
+}
+
+// -- Methods --
+void GlDebugOutput::setMinSeverity(GLenum minSeverity) {
+    if (!isActive())
+        return;
+
+    // from the least to the most severe
+    constexpr GLenum SEVERITIES[] = {GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM,
+                                     GL_DEBUG_SEVERITY_HIGH};
+    bool enabled = false;
+    for (GLenum severity : SEVERITIES) {
+        enabled = enabled || severity == minSeverity;
+        s_debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr, enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void GlDebugOutput::label(GLenum identifier, GLuint name, std::string_view text) {
+    if (s_objectLabel == nullptr)
+        return;
+
+    // the length must stay below GL_MAX_LABEL_LENGTH (at least 256)
+    GLsizei length = static_cast<GLsizei>(std::min<size_t>(text.size(), s_maxLabelLength - 1));
+    s_objectLabel(identifier, name, length, text.data());
+}
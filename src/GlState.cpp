@@ -0,0 +1,232 @@
+#include "GlState.hpp"
+
+#include <iterator>
+
+#include "gl_utils.hpp"
+
+// -- Private utils --
+
+namespace {
+
+constexpr GLuint UNKNOWN = ~0u;
+
+constexpr GLenum TEXTURE_TARGETS[] = {GL_TEXTURE_1D, GL_TEXTURE_2D, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP,
+                                      GL_TEXTURE_2D_ARRAY};
+constexpr GLenum BUFFER_TARGETS[] = {GL_ARRAY_BUFFER,        GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER,
+                                     GL_PIXEL_UNPACK_BUFFER, GL_PIXEL_PACK_BUFFER,    GL_COPY_READ_BUFFER,
+                                     GL_COPY_WRITE_BUFFER};
+constexpr GLenum CAPABILITIES[] = {GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_STENCIL_TEST, GL_SCISSOR_TEST};
+
+constexpr size_t TEXTURE_TARGET_COUNT = std::size(TEXTURE_TARGETS);
+constexpr size_t BUFFER_TARGET_COUNT = std::size(BUFFER_TARGETS);
+constexpr size_t CAPABILITY_COUNT = std::size(CAPABILITIES);
+
+// @returns the index of value in table, count if absent
+template <size_t N>
+size_t indexOf(const GLenum (&table)[N], GLenum value) {
+    for (size_t i = 0; i < N; i++)
+        if (table[i] == value)
+            return i;
+    return N;
+}
+
+struct State {
+    GLuint activeUnit;
+    GLuint textures[GlState::MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+    GLuint program;
+    GLuint vertexArray;
+    GLuint buffers[BUFFER_TARGET_COUNT];
+
+    GLuint capabilities[CAPABILITY_COUNT]; // 0, 1 or UNKNOWN
+    GLenum depthFunc;
+    GLuint depthMask;
+    GLenum blendSource;
+    GLenum blendDestination;
+};
+
+// every value unknown, the next call reaches GL whatever its value
+State unknownState() {
+    State state;
+    state.activeUnit = UNKNOWN;
+    for (auto& unit : state.textures)
+        for (GLuint& bound : unit)
+            bound = UNKNOWN;
+    state.program = UNKNOWN;
+    state.vertexArray = UNKNOWN;
+    for (GLuint& bound : state.buffers)
+        bound = UNKNOWN;
+
+    for (GLuint& enabled : state.capabilities)
+        enabled = UNKNOWN;
+    state.depthFunc = UNKNOWN;
+    state.depthMask = UNKNOWN;
+    state.blendSource = UNKNOWN;
+    state.blendDestination = UNKNOWN;
+    return state;
+}
+
+// a freshly created context is not trusted either
+State s_state = unknownState();
+GlStateStats s_stats;
+
+// @returns true if the call is needed, counting it either way
+bool update(GLuint& cached, GLuint value, GlCallCounter& counter) {
+    if (cached == value) {
+        counter.elided++;
+        return false;
+    }
+    cached = value;
+    counter.issued++;
+    return true;
+}
+
+} // namespace
+
+// -- Bindings --
+void GlState::activeTexture(GLuint unit) {
+    // unit switches are counted with the texture binds they serve
+    if (s_state.activeUnit == unit)
+        return;
+    s_state.activeUnit = unit;
+    glCall(glActiveTexture(GL_TEXTURE0 + unit));
+}
+
+void GlState::bindTexture(GLenum target, GLuint texture) {
+    size_t targetIndex = indexOf(TEXTURE_TARGETS, target);
+    if (targetIndex == TEXTURE_TARGET_COUNT || s_state.activeUnit >= MAX_TEXTURE_UNITS) {
+        s_stats.textures.issued++;
+        glCall(glBindTexture(target, texture));
+        return;
+    }
+
+    if (update(s_state.textures[s_state.activeUnit][targetIndex], texture, s_stats.textures)) {
+        glCall(glBindTexture(target, texture));
+    }
+}
+
+void GlState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    size_t targetIndex = indexOf(TEXTURE_TARGETS, target);
+    if (targetIndex != TEXTURE_TARGET_COUNT && unit < MAX_TEXTURE_UNITS &&
+        s_state.textures[unit][targetIndex] == texture) {
+        // already there, no need to switch the active unit either
+        s_stats.textures.elided++;
+        return;
+    }
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+void GlState::useProgram(GLuint program) {
+    if (update(s_state.program, program, s_stats.programs)) {
+        glCall(glUseProgram(program));
+    }
+}
+
+void GlState::bindVertexArray(GLuint vertexArray) {
+    if (update(s_state.vertexArray, vertexArray, s_stats.vertexArrays)) {
+        glCall(glBindVertexArray(vertexArray));
+        // each VAO has its own element array binding
+        s_state.buffers[indexOf(BUFFER_TARGETS, GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+    }
+}
+
+void GlState::bindBuffer(GLenum target, GLuint buffer) {
+    size_t targetIndex = indexOf(BUFFER_TARGETS, target);
+    if (targetIndex == BUFFER_TARGET_COUNT) {
+        s_stats.buffers.issued++;
+        glCall(glBindBuffer(target, buffer));
+        return;
+    }
+
+    if (update(s_state.buffers[targetIndex], buffer, s_stats.buffers)) {
+        glCall(glBindBuffer(target, buffer));
+    }
+}
+
+void GlState::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    // indexed bindings are not cached, only the generic one they overwrite
+    s_stats.buffers.issued++;
+    glCall(glBindBufferBase(target, index, buffer));
+
+    size_t targetIndex = indexOf(BUFFER_TARGETS, target);
+    if (targetIndex != BUFFER_TARGET_COUNT)
+        s_state.buffers[targetIndex] = buffer;
+}
+
+// -- Fixed function state --
+void GlState::setEnabled(GLenum capability, bool enabled) {
+    size_t capabilityIndex = indexOf(CAPABILITIES, capability);
+    if (capabilityIndex == CAPABILITY_COUNT)
+        s_stats.capabilities.issued++;
+    else if (!update(s_state.capabilities[capabilityIndex], enabled, s_stats.capabilities))
+        return;
+
+    if (enabled) {
+        glCall(glEnable(capability));
+    } else {
+        glCall(glDisable(capability));
+    }
+}
+
+void GlState::depthFunc(GLenum func) {
+    if (update(s_state.depthFunc, func, s_stats.capabilities)) {
+        glCall(glDepthFunc(func));
+    }
+}
+
+void GlState::depthMask(GLboolean write) {
+    if (update(s_state.depthMask, write, s_stats.capabilities)) {
+        glCall(glDepthMask(write));
+    }
+}
+
+void GlState::blendFunc(GLenum source, GLenum destination) {
+    if (s_state.blendSource == source && s_state.blendDestination == destination) {
+        s_stats.capabilities.elided++;
+        return;
+    }
+    s_state.blendSource = source;
+    s_state.blendDestination = destination;
+    s_stats.capabilities.issued++;
+    glCall(glBlendFunc(source, destination));
+}
+
+// -- Deletion --
+void GlState::forgetTexture(GLuint texture) {
+    for (auto& unit : s_state.textures)
+        for (GLuint& bound : unit)
+            if (bound == texture)
+                bound = 0;
+}
+
+void GlState::forgetProgram(GLuint program) {
+    // a deleted program stays in use until another one replaces it
+    if (s_state.program == program)
+        s_state.program = UNKNOWN;
+}
+
+void GlState::forgetVertexArray(GLuint vertexArray) {
+    if (s_state.vertexArray == vertexArray) {
+        s_state.vertexArray = 0;
+        s_state.buffers[indexOf(BUFFER_TARGETS, GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+    }
+}
+
+void GlState::forgetBuffer(GLuint buffer) {
+    for (GLuint& bound : s_state.buffers)
+        if (bound == buffer)
+            bound = 0;
+}
+
+void GlState::invalidate() {
+    s_state = unknownState();
+}
+
+// -- Stats --
+const GlStateStats& GlState::getStats() {
+    return s_stats;
+}
+
+void GlState::resetStats() {
+    s_stats = GlStateStats();
+}
@@ -0,0 +1,66 @@
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+
+// -- Constructors --
+MappedFile::MappedFile(const char* path) : m_data(nullptr), m_size(0) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error(std::string("ERROR::MAPPED_FILE::OPEN_FAILED ") + path);
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == -1) {
+        close(fd);
+        throw std::runtime_error(std::string("ERROR::MAPPED_FILE::STAT_FAILED ") + path);
+    }
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    // mmap refuses empty mappings, an empty file is just an empty range
+    if (m_size > 0) {
+        void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error(std::string("ERROR::MAPPED_FILE::MMAP_FAILED ") + path);
+        }
+        madvise(mapping, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(mapping);
+    }
+
+    // the mapping stays valid once the descriptor is closed
+    close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : m_data(other.m_data), m_size(other.m_size) {
+    other.m_data = nullptr;
+    other.m_size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+// -- Destructor --
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+// -- Private methods --
+void MappedFile::unmap() {
+    if (m_data != nullptr)
+        munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
@@ -0,0 +1,51 @@
+#include "Mesh.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+// -- Private utils --
+
+static uint64_t hashVertex(const float* vertex, size_t stride) {
+    // FNV-1a over the raw bytes, identical vertices are bitwise identical
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertex);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < stride * sizeof(float); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// -- Welding --
+
+MeshData weldVertices(const float* vertices, size_t vertexCount, size_t stride) {
+    MeshData mesh;
+    mesh.stride = stride;
+    mesh.indices.reserve(vertexCount);
+
+    // open addressing table of indices into mesh.vertices, at most half full
+    size_t tableSize = 16;
+    while (tableSize < vertexCount * 2)
+        tableSize *= 2;
+    const unsigned int EMPTY = UINT32_MAX;
+    std::vector<unsigned int> table(tableSize, EMPTY);
+
+    unsigned int uniqueCount = 0;
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float* vertex = vertices + v * stride;
+
+        size_t slot = hashVertex(vertex, stride) & (tableSize - 1);
+        while (table[slot] != EMPTY &&
+               std::memcmp(mesh.vertices.data() + table[slot] * stride, vertex, stride * sizeof(float)) != 0)
+            slot = (slot + 1) & (tableSize - 1);
+
+        if (table[slot] == EMPTY) {
+            table[slot] = uniqueCount++;
+            mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + stride);
+        }
+        mesh.indices.push_back(table[slot]);
+    }
+
+    mesh.vertices.shrink_to_fit();
+    return mesh;
+}
@@ -0,0 +1,117 @@
+#include "MeshFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// -- Private utils --
+
+namespace {
+
+size_t alignUp(size_t offset) {
+    return (offset + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+}
+
+template <typename I>
+void writeIndices(std::ofstream& file, const std::vector<unsigned int>& indices) {
+    std::vector<I> narrowed(indices.begin(), indices.end());
+    file.write(reinterpret_cast<const char*>(narrowed.data()), narrowed.size() * sizeof(I));
+}
+
+void writePadding(std::ofstream& file, size_t offset) {
+    static const char ZEROS[MESH_FILE_ALIGNMENT] = {};
+    file.write(ZEROS, alignUp(offset) - offset);
+}
+
+} // namespace
+
+// -- Constructors --
+MeshFile::MeshFile(const char* path) : m_file(path), m_header(nullptr) {
+    if (m_file.size() < sizeof(MeshFileHeader))
+        throw std::runtime_error(std::string("ERROR::MESH_FILE::TRUNCATED ") + path);
+
+    m_header = reinterpret_cast<const MeshFileHeader*>(m_file.data());
+
+    if (std::memcmp(m_header->magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) != 0)
+        throw std::runtime_error(std::string("ERROR::MESH_FILE::BAD_MAGIC ") + path);
+    if (m_header->version != MESH_FILE_VERSION)
+        throw std::runtime_error(std::string("ERROR::MESH_FILE::VERSION_MISMATCH ") + path +
+                                 ", rebake the meshes");
+    if (m_header->attributeCount > MESH_FILE_MAX_ATTRIBUTES)
+        throw std::runtime_error(std::string("ERROR::MESH_FILE::TOO_MANY_ATTRIBUTES ") + path);
+
+    const size_t indicesSize = size_t(m_header->indexCount) * glTypeSize(m_header->indexType);
+    if (m_header->vertexOffset + getVerticesSize() > m_file.size() ||
+        m_header->indexOffset + indicesSize > m_file.size())
+        throw std::runtime_error(std::string("ERROR::MESH_FILE::TRUNCATED ") + path);
+}
+
+// -- Getters --
+VertexLayout MeshFile::getLayout() const {
+    VertexLayout layout;
+    for (uint32_t i = 0; i < m_header->attributeCount; i++) {
+        const MeshFileAttribute& attribute = m_header->attributes[i];
+        layout.push({attribute.glType, attribute.count, attribute.normalized != 0});
+    }
+    return layout;
+}
+
+const std::byte* MeshFile::getVertices() const {
+    return reinterpret_cast<const std::byte*>(m_file.data() + m_header->vertexOffset);
+}
+
+const void* MeshFile::getIndices() const {
+    return m_file.data() + m_header->indexOffset;
+}
+
+// -- Writing --
+void writeMeshFile(const char* path, const MeshData& mesh, const VertexLayout& layout) {
+    const auto& elements = layout.getElements();
+    if (elements.size() > MESH_FILE_MAX_ATTRIBUTES)
+        throw std::runtime_error("ERROR::MESH_FILE::TOO_MANY_ATTRIBUTES");
+    if (layout.getStride() != mesh.stride * sizeof(float))
+        throw std::runtime_error("ERROR::MESH_FILE::LAYOUT_DOES_NOT_MATCH_MESH");
+
+    MeshFileHeader header = {};
+    std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC));
+    header.version = MESH_FILE_VERSION;
+
+    header.attributeCount = static_cast<uint32_t>(elements.size());
+    for (size_t i = 0; i < elements.size(); i++)
+        header.attributes[i] = {elements[i].glType, static_cast<uint32_t>(elements[i].count),
+                                elements[i].normalized};
+    header.stride = static_cast<uint32_t>(layout.getStride());
+
+    const unsigned int maxIndex =
+        mesh.indices.empty() ? 0 : *std::max_element(mesh.indices.begin(), mesh.indices.end());
+    header.vertexCount = static_cast<uint32_t>(mesh.vertices.size() / mesh.stride);
+    header.indexType = maxIndex <= 0xFF     ? GL_UNSIGNED_BYTE
+                       : maxIndex <= 0xFFFF ? GL_UNSIGNED_SHORT
+                                            : GL_UNSIGNED_INT;
+    header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+
+    const size_t verticesSize = mesh.vertices.size() * sizeof(float);
+    header.vertexOffset = alignUp(sizeof(MeshFileHeader));
+    header.indexOffset = alignUp(header.vertexOffset + verticesSize);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error(std::string("ERROR::MESH_FILE::OPEN_FAILED ") + path);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writePadding(file, sizeof(header));
+    file.write(reinterpret_cast<const char*>(mesh.vertices.data()), verticesSize);
+    writePadding(file, header.vertexOffset + verticesSize);
+
+    switch (header.indexType) {
+        case GL_UNSIGNED_BYTE:  writeIndices<GLubyte>(file, mesh.indices); break;
+        case GL_UNSIGNED_SHORT: writeIndices<GLushort>(file, mesh.indices); break;
+        default:                writeIndices<GLuint>(file, mesh.indices); break;
+    }
+
+    if (!file)
+        throw std::runtime_error(std::string("ERROR::MESH_FILE::WRITE_FAILED ") + path);
+}
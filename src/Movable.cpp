@@ -5,7 +5,9 @@
 // -- Constructors --
 
 Transform::Transform(glm::vec3 position, glm::vec3 size, glm::quat rotation)
-    : m_position(position), m_size(size), m_rotation(rotation) {}
+    : m_position(position), m_size(size), m_rotation(rotation),
+    m_transforms(1.0f), m_transformsInverse(1.0f),
+    m_transformsDirty(true), m_inverseDirty(true), m_version(0) {}
 Transform::Transform()
     : Transform(glm::vec3(0.0f), glm::vec3(1.0f), glm::quat(1.0f,0.0f,0.0f,0.0f)) {}
 Transform::Transform(float position[3], float size[3], float rotation[4])
@@ -16,25 +18,45 @@ Transform::Transform(float position[3], float size[3], float rotation[4])
 
 // -- Movable implementation --
 
-void Transform::setPos(glm::vec3 pos) {m_position = pos;}
-void Transform::setSize(glm::vec3 size) {m_size = size;}
-void Transform::setRotation(glm::quat rotation){m_rotation = rotation;}
+// setting the current value keeps the cache and the version
+void Transform::setPos(glm::vec3 pos) {
+    if (pos == m_position) return;
+    m_position = pos;
+    markDirty();
+}
+void Transform::setSize(glm::vec3 size) {
+    if (size == m_size) return;
+    m_size = size;
+    markDirty();
+}
+void Transform::setRotation(glm::quat rotation){
+    if (rotation == m_rotation) return;
+    m_rotation = rotation;
+    markDirty();
+}
 
 glm::vec3 Transform::getPos() const {return m_position;}
 glm::vec3 Transform::getSize() const {return m_size;}
 glm::quat Transform::getRotation() const {return m_rotation;}
 
-void Transform::translate(glm::vec3 trans) {m_position += trans;}
-void Transform::scale(glm::vec3 scale) {m_size *= scale;}
-void Transform::rotate(glm::quat rotation) {m_rotation = rotation * m_rotation;}
+void Transform::translate(glm::vec3 trans) {m_position += trans; markDirty();}
+void Transform::scale(glm::vec3 scale) {m_size *= scale; markDirty();}
+void Transform::rotate(glm::quat rotation) {m_rotation = rotation * m_rotation; markDirty();}
 
 glm::mat4 Transform::getTransforms() const {
-    glm::mat4 transforms = glm::translate(glm::mat4(1.0f), m_position);
-    transforms *= glm::mat4_cast(m_rotation);
-    return glm::scale(transforms, m_size);
+    if (m_transformsDirty) {
+        m_transforms = glm::translate(glm::mat4(1.0f), m_position);
+        m_transforms *= glm::mat4_cast(m_rotation);
+        m_transforms = glm::scale(m_transforms, m_size);
+        m_transformsDirty = false;
+    }
+    return m_transforms;
 }
 
 glm::mat4 Transform::getTransformsInverse() const {
+    if (!m_inverseDirty)
+        return m_transformsInverse;
+
     // Prevent division by zero
     glm::vec3 safeInvScale(
         m_size.x != 0.0f ? 1.0f / m_size.x : 0.0f,
@@ -44,6 +66,20 @@ glm::mat4 Transform::getTransformsInverse() const {
 
     glm::mat4 inv = glm::scale(glm::mat4(1.0f), safeInvScale);
     inv *= glm::mat4_cast(glm::inverse(m_rotation));
-    return glm::translate(inv, -m_position);
+    m_transformsInverse = glm::translate(inv, -m_position);
+    m_inverseDirty = false;
+    return m_transformsInverse;
+
+}
+
+glm::mat3 Transform::getNormalMatrix() const {
+    return glm::transpose(glm::mat3(getTransformsInverse()));
+}
+
+// -- Protected methods --
 
-}   
+void Transform::markDirty() {
+    m_transformsDirty = true;
+    m_inverseDirty = true;
+    m_version++;
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "ObjLoader.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+// -- Private utils --
+
+namespace {
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool isDigit(char c) { return static_cast<unsigned char>(c - '0') < 10; }
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p))
+        p++;
+    return p;
+}
+
+inline const char* skipLine(const char* p, const char* end) {
+    while (p < end && *p != '\n')
+        p++;
+    return p < end ? p + 1 : end;
+}
+
+// Decimal float parser for the "-1.000000" / "1e-3" numbers found in OBJ files,
+// no locale and no stream involved
+const char* parseFloat(const char* p, const char* end, float& value) {
+    static const double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                   1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                   1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    p = skipBlanks(p, end);
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    // mantissa digits past the 19th one do not fit, they only scale the value
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; p < end && isDigit(*p); p++) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0)
+                digits++;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && isDigit(*p); p++) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+                if (mantissa != 0)
+                    digits++;
+            }
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            p++;
+        }
+        int e = 0;
+        for (; p < end && isDigit(*p); p++)
+            e = e < 10000 ? e * 10 + (*p - '0') : e;
+        exponent += negativeExponent ? -e : e;
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (exponent < 0)
+        result = -exponent <= 22 ? result / POW10[-exponent] : result * std::pow(10.0, exponent);
+    else if (exponent > 0)
+        result = exponent <= 22 ? result * POW10[exponent] : result * std::pow(10.0, exponent);
+
+    value = static_cast<float>(negative ? -result : result);
+    return p;
+}
+
+const char* parseInt(const char* p, const char* end, long& value) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    long result = 0;
+    for (; p < end && isDigit(*p); p++)
+        result = result * 10 + (*p - '0');
+    value = negative ? -result : result;
+    return p;
+}
+
+// One face corner, the 0 based indices of its position, uv and normal,
+// UINT32_MAX when the corner has none
+struct Corner {
+    uint32_t position;
+    uint32_t uv;
+    uint32_t normal;
+
+    bool operator==(const Corner& other) const {
+        return position == other.position && uv == other.uv && normal == other.normal;
+    }
+};
+
+// Welds the corners sharing the same indices into one vertex,
+// open addressing table kept at most half full. The keys are stored in the
+// slots so a lookup touches a single cache line.
+class CornerTable {
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    struct Slot {
+        Corner corner;
+        uint32_t vertex;
+    };
+
+    std::vector<Slot> m_slots;
+    uint32_t m_count;
+
+public:
+    CornerTable() : m_slots(1024, Slot{{}, EMPTY}), m_count(0) {}
+
+    // @returns the vertex index of the corner and whether it was just added
+    std::pair<uint32_t, bool> insert(const Corner& corner) {
+        if ((m_count + 1) * 2 > m_slots.size())
+            grow();
+
+        Slot& slot = m_slots[findSlot(corner)];
+        if (slot.vertex != EMPTY)
+            return {slot.vertex, false};
+
+        slot = Slot{corner, m_count++};
+        return {slot.vertex, true};
+    }
+
+private:
+    static size_t hash(const Corner& c) {
+        uint64_t h = c.position * 0x9E3779B97F4A7C15ull;
+        h ^= (c.uv + 0x632BE59BD9B4E019ull) * 0xBF58476D1CE4E5B9ull;
+        h ^= (c.normal + 0x94D049BB133111EBull) * 0xC2B2AE3D27D4EB4Full;
+        return h ^ (h >> 31);
+    }
+
+    size_t findSlot(const Corner& corner) const {
+        const size_t mask = m_slots.size() - 1;
+        size_t slot = hash(corner) & mask;
+        while (m_slots[slot].vertex != EMPTY && !(m_slots[slot].corner == corner))
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void grow() {
+        std::vector<Slot> old(m_slots.size() * 2, Slot{{}, EMPTY});
+        old.swap(m_slots);
+        for (const Slot& slot : old)
+            if (slot.vertex != EMPTY)
+                m_slots[findSlot(slot.corner)] = slot;
+    }
+};
+
+// OBJ indices are 1 based, negative ones count back from the last element
+inline uint32_t resolveIndex(long index, size_t count) {
+    if (index > 0 && static_cast<size_t>(index) <= count)
+        return static_cast<uint32_t>(index - 1);
+    if (index < 0 && static_cast<size_t>(-index) <= count)
+        return static_cast<uint32_t>(count + index);
+    throw std::runtime_error("ERROR::OBJ::INDEX_OUT_OF_RANGE");
+}
+
+}  // namespace
+
+// -- Loading --
+
+MeshData loadObj(const char* path) {
+    MappedFile file(path);
+    return parseObj(file.begin(), file.end());
+}
+
+MeshData parseObj(const char* begin, const char* end) {
+    std::vector<float> positions, normals, uvs;
+    std::vector<uint32_t> face;
+    CornerTable corners;
+
+    MeshData mesh;
+    mesh.stride = OBJ_VERTEX_STRIDE;
+
+    const char* p = begin;
+    while (p < end) {
+        p = skipBlanks(p, end);
+        if (p + 1 >= end) break;
+
+        if (p[0] == 'v' && isBlank(p[1])) {
+            float x, y, z;
+            p = parseFloat(p + 1, end, x);
+            p = parseFloat(p, end, y);
+            p = parseFloat(p, end, z);
+            positions.insert(positions.end(), {x, y, z});
+        } else if (p[0] == 'v' && p[1] == 'n') {
+            float x, y, z;
+            p = parseFloat(p + 2, end, x);
+            p = parseFloat(p, end, y);
+            p = parseFloat(p, end, z);
+            normals.insert(normals.end(), {x, y, z});
+        } else if (p[0] == 'v' && p[1] == 't') {
+            float u, v;
+            p = parseFloat(p + 2, end, u);
+            p = parseFloat(p, end, v);
+            uvs.insert(uvs.end(), {u, v});
+        } else if (p[0] == 'f' && isBlank(p[1])) {
+            face.clear();
+            p = skipBlanks(p + 1, end);
+            while (p < end && *p != '\n') {
+                // v, v/vt, v//vn or v/vt/vn
+                Corner corner = {UINT32_MAX, UINT32_MAX, UINT32_MAX};
+                long index;
+                p = parseInt(p, end, index);
+                corner.position = resolveIndex(index, positions.size() / 3);
+                if (p < end && *p == '/') {
+                    p++;
+                    if (p < end && *p != '/') {
+                        p = parseInt(p, end, index);
+                        corner.uv = resolveIndex(index, uvs.size() / 2);
+                    }
+                    if (p < end && *p == '/') {
+                        p = parseInt(p + 1, end, index);
+                        corner.normal = resolveIndex(index, normals.size() / 3);
+                    }
+                }
+
+                auto [vertex, added] = corners.insert(corner);
+                if (added) {
+                    const float* pos = &positions[corner.position * 3];
+                    mesh.vertices.insert(mesh.vertices.end(), pos, pos + 3);
+                    if (corner.normal != UINT32_MAX) {
+                        const float* normal = &normals[corner.normal * 3];
+                        mesh.vertices.insert(mesh.vertices.end(), normal, normal + 3);
+                    } else {
+                        mesh.vertices.insert(mesh.vertices.end(), {0.0f, 0.0f, 0.0f});
+                    }
+                    if (corner.uv != UINT32_MAX) {
+                        const float* uv = &uvs[corner.uv * 2];
+                        mesh.vertices.insert(mesh.vertices.end(), uv, uv + 2);
+                    } else {
+                        mesh.vertices.insert(mesh.vertices.end(), {0.0f, 0.0f});
+                    }
+                }
+                face.push_back(vertex);
+                p = skipBlanks(p, end);
+            }
+
+            // triangle fan
+            for (size_t i = 2; i < face.size(); i++)
+                mesh.indices.insert(mesh.indices.end(), {face[0], face[i - 1], face[i]});
+        }
+
+        p = skipLine(p, end);
+    }
+
+    return mesh;
+}
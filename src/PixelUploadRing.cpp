@@ -0,0 +1,94 @@
+#include "PixelUploadRing.hpp"
+
+#include "GlDebug.hpp"
+#include "GlState.hpp"
+#include "gl_utils.hpp"
+
+// -- Constructors --
+PixelUploadRing::PixelUploadRing(size_t slotCount) : m_slots() {
+    m_slots.reserve(slotCount);
+    for (size_t i = 0; i < slotCount; i++)
+        m_slots.push_back({PixelUnpackBuffer<GLubyte>(), 0, nullptr, nullptr});
+}
+
+// -- Destructor --
+PixelUploadRing::~PixelUploadRing() {
+    for (Slot& slot : m_slots) {
+        if (slot.mapped != nullptr)
+            slot.buffer.unmap();
+        if (slot.fence != nullptr)
+            glDeleteSync(slot.fence);
+    }
+    GlState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// -- Methods --
+int PixelUploadRing::acquire(size_t size) {
+    for (size_t i = 0; i < m_slots.size(); i++) {
+        Slot& slot = m_slots[i];
+        if (slot.mapped != nullptr || isInFlight(slot))
+            continue;
+
+        if (slot.capacity < size) {
+            slot.buffer.uploadData(nullptr, size, GL_STREAM_DRAW);
+            slot.capacity = size;
+        }
+
+        // the fence already told the GPU is done with the slot, no need for
+        // the driver to check again
+        slot.mapped = slot.buffer.mapRange(
+            0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        GlState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void PixelUploadRing::upload(int slotIndex, Texture& texture, GLsizei width, GLsizei height) {
+    Slot& slot = m_slots[slotIndex];
+    unmap(slot);
+
+    // the buffer stays bound while setImage runs, the pixel pointer is then
+    // an offset in it and the copy is done by the GPU
+    texture.setImage(width, height, nullptr);
+    release(slot);
+}
+
+void PixelUploadRing::upload(int slotIndex, TextureArray& array, GLint layer, GLsizei imageWidth,
+                             GLsizei imageHeight) {
+    Slot& slot = m_slots[slotIndex];
+    unmap(slot);
+
+    // same as above with setLayer
+    array.setLayer(layer, imageWidth, imageHeight, nullptr);
+    release(slot);
+}
+
+// -- Private methods --
+void PixelUploadRing::unmap(Slot& slot) {
+    slot.buffer.unmap();
+    slot.mapped = nullptr;
+}
+
+void PixelUploadRing::release(Slot& slot) {
+    GlState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // the copies above go through glCall, only the fence is left to check and
+    // the debug output already reports it when active
+    if (!GlDebugOutput::isActive())
+        throwOnGlError("Error while streaming a texture");
+}
+
+bool PixelUploadRing::isInFlight(Slot& slot) {
+    if (slot.fence == nullptr)
+        return false;
+
+    GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return true;
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    return false;
+}
@@ -0,0 +1,233 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#include "gl_utils.hpp"
+
+// -- Private utils --
+
+namespace {
+
+constexpr uint32_t GPU_TRACK = 0;
+
+double toMilliseconds(Profiler::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double toMicroseconds(Profiler::Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+// names are literals but may still hold characters JSON does not take raw
+void writeJsonString(std::ostream& stream, const char* text) {
+    stream << '"';
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\')
+            stream << '\\' << *c;
+        else if (static_cast<unsigned char>(*c) >= 0x20)
+            stream << *c;
+    }
+    stream << '"';
+}
+
+} // namespace
+
+// -- SampleHistory --
+SampleHistory::SampleHistory(size_t capacity) : m_samples(), m_next(0) {
+    m_samples.reserve(capacity);
+}
+
+void SampleHistory::add(double sample) {
+    if (m_samples.size() < m_samples.capacity()) {
+        m_samples.push_back(sample);
+        return;
+    }
+    m_samples[m_next] = sample;
+    m_next = (m_next + 1) % m_samples.size();
+}
+
+ProfileStats SampleHistory::computeStats() const {
+    ProfileStats stats;
+    stats.sampleCount = m_samples.size();
+    if (m_samples.empty())
+        return stats;
+
+    std::vector<double> sorted(m_samples);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::max<size_t>(rank, 1) - 1];
+    };
+    stats.p50 = percentile(0.50);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    return stats;
+}
+
+// -- Constructors --
+Profiler::Profiler(size_t framesInFlight)
+    : m_origin(Clock::now()),
+      m_frameStart(),
+      m_inFrame(false),
+      m_frameTimes(HISTORY_SIZE),
+      m_gpuTimes(),
+      m_frames(std::max<size_t>(framesInFlight, 1)),
+      m_frameIndex(0),
+      m_gpuPassOpen(false),
+      m_droppedGpuResults(0),
+      m_traceMutex(),
+      m_trace(),
+      m_tracks() {
+    for (FrameQueries& frame : m_frames) {
+        frame.passes.resize(MAX_GPU_PASSES);
+        frame.used = 0;
+        for (GpuPass& pass : frame.passes) {
+            glCall(glGenQueries(1, &pass.query));
+        }
+    }
+}
+
+// -- Destructor --
+Profiler::~Profiler() {
+    for (FrameQueries& frame : m_frames)
+        for (GpuPass& pass : frame.passes)
+            glDeleteQueries(1, &pass.query);
+}
+
+// -- Frames --
+void Profiler::beginFrame() {
+    Clock::time_point now = Clock::now();
+    if (m_inFrame)
+        endFrame();
+    if (m_frameStart != Clock::time_point())
+        m_frameTimes.add(toMilliseconds(now - m_frameStart));
+    m_frameStart = now;
+    m_inFrame = true;
+
+    // the slot was last used framesInFlight frames ago
+    m_frameIndex++;
+    FrameQueries& frame = m_frames[m_frameIndex % m_frames.size()];
+    resolve(frame);
+}
+
+void Profiler::endFrame() {
+    if (!m_inFrame)
+        return;
+    if (m_gpuPassOpen)
+        endGpu();
+    recordCpu("frame", m_frameStart, Clock::now());
+    m_inFrame = false;
+}
+
+// -- Scopes --
+void Profiler::recordCpu(const char* name, Clock::time_point start, Clock::time_point end) {
+    std::lock_guard<std::mutex> lock(m_traceMutex);
+    auto track = m_tracks.try_emplace(std::this_thread::get_id(), static_cast<uint32_t>(m_tracks.size() + 1)).first;
+    if (m_trace.size() < MAX_TRACE_EVENTS)
+        m_trace.push_back({name, start, end - start, track->second});
+}
+
+void Profiler::beginGpu(const char* name) {
+    if (m_gpuPassOpen)
+        throw std::runtime_error("ERROR::PROFILER::GPU_PASSES_CANNOT_NEST");
+
+    FrameQueries& frame = m_frames[m_frameIndex % m_frames.size()];
+    if (frame.used == frame.passes.size())
+        return; // over budget, the pass is not timed
+
+    GpuPass& pass = frame.passes[frame.used++];
+    pass.name = name;
+    pass.submitted = Clock::now();
+    glCall(glBeginQuery(GL_TIME_ELAPSED, pass.query));
+    m_gpuPassOpen = true;
+}
+
+void Profiler::endGpu() {
+    if (!m_gpuPassOpen)
+        return;
+    glCall(glEndQuery(GL_TIME_ELAPSED));
+    m_gpuPassOpen = false;
+}
+
+// -- Getters --
+ProfileStats Profiler::getFrameStats() const {
+    return m_frameTimes.computeStats();
+}
+
+ProfileStats Profiler::getGpuStats(const std::string& name) const {
+    auto it = m_gpuTimes.find(name);
+    if (it == m_gpuTimes.end())
+        return ProfileStats();
+    return it->second.computeStats();
+}
+
+// -- Export --
+void Profiler::printStats(std::ostream& stream) const {
+    ProfileStats frame = getFrameStats();
+    stream << "frame (ms) p50 " << frame.p50 << " | p95 " << frame.p95 << " | p99 " << frame.p99 << " over "
+           << frame.sampleCount << " frames\n";
+    for (const auto& [name, history] : m_gpuTimes) {
+        ProfileStats gpu = history.computeStats();
+        stream << "  GPU " << name << " (ms) p50 " << gpu.p50 << " | p95 " << gpu.p95 << " | p99 " << gpu.p99
+               << "\n";
+    }
+    if (m_droppedGpuResults != 0)
+        stream << "  " << m_droppedGpuResults << " GPU results not ready in time, dropped\n";
+}
+
+void Profiler::writeChromeTrace(const char* path) const {
+    std::ofstream file(path);
+    if (!file)
+        throw std::runtime_error(std::string("ERROR::PROFILER::CANNOT_WRITE_TRACE ") + path);
+
+    std::lock_guard<std::mutex> lock(m_traceMutex);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << GPU_TRACK
+         << ",\"args\":{\"name\":\"GPU\"}}";
+    for (const auto& [id, track] : m_tracks)
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << track
+             << ",\"args\":{\"name\":\"CPU " << track << "\"}}";
+
+    for (const TraceEvent& event : m_trace) {
+        file << ",\n{\"name\":";
+        writeJsonString(file, event.name);
+        file << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.track
+             << ",\"ts\":" << toMicroseconds(event.start - m_origin)
+             << ",\"dur\":" << toMicroseconds(event.duration) << "}";
+    }
+    file << "\n]}\n";
+
+    if (!file)
+        throw std::runtime_error(std::string("ERROR::PROFILER::CANNOT_WRITE_TRACE ") + path);
+}
+
+// -- Private methods --
+void Profiler::resolve(FrameQueries& frame) {
+    for (size_t i = 0; i < frame.used; i++) {
+        GpuPass& pass = frame.passes[i];
+
+        GLint available = GL_FALSE;
+        glCall(glGetQueryObjectiv(pass.query, GL_QUERY_RESULT_AVAILABLE, &available));
+        if (!available) {
+            m_droppedGpuResults++;
+            continue;
+        }
+
+        GLuint64 elapsed = 0;
+        glCall(glGetQueryObjectui64v(pass.query, GL_QUERY_RESULT, &elapsed));
+        auto duration = std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(elapsed));
+
+        m_gpuTimes.try_emplace(pass.name, HISTORY_SIZE).first->second.add(toMilliseconds(duration));
+        trace(pass.name, pass.submitted, duration, GPU_TRACK);
+    }
+    frame.used = 0;
+}
+
+void Profiler::trace(const char* name, Clock::time_point start, Clock::duration duration, uint32_t track) {
+    std::lock_guard<std::mutex> lock(m_traceMutex);
+    if (m_trace.size() < MAX_TRACE_EVENTS)
+        m_trace.push_back({name, start, duration, track});
+}
@@ -4,7 +4,10 @@
 #include <cstring>
 #include <unordered_map>
 #include <stdexcept>
+#include <algorithm>
 
+#include "GlDebug.hpp"
+#include "GlState.hpp"
 
 using std::byte;
 
@@ -14,6 +17,7 @@ Program::Program(VertexShader&& vert_shad, FragmentShader&& frag_shad)
     {
         m_glId = glCall(glCreateProgram());
         attachGlShader(m_glId,m_vert,m_frag);
+        reflectUniforms();
     }
 
 Program::Program(const char* vert_shad_src, const char* frag_shad_src)
@@ -23,7 +27,15 @@ Program::Program(const char* vert_shad_src, const char* frag_shad_src)
 Program::Program(Program&& rvalue)
     : m_vert(std::move(rvalue.m_vert)), 
     m_frag(std::move(rvalue.m_frag)), 
-    m_glId(rvalue.m_glId) 
+    m_glId(rvalue.m_glId),
+    m_uniformPool(std::move(rvalue.m_uniformPool)),
+    m_uniformIndices(std::move(rvalue.m_uniformIndices)),
+    m_uniformArena(std::move(rvalue.m_uniformArena)),
+    m_uploadedArena(std::move(rvalue.m_uploadedArena)),
+    m_dirtyUniforms(std::move(rvalue.m_dirtyUniforms)),
+    m_uploadStats(rvalue.m_uploadStats),
+    m_samplers(std::move(rvalue.m_samplers)),
+    m_samplerIndices(std::move(rvalue.m_samplerIndices))
     {
         rvalue.m_glId = 0;
     }
@@ -32,15 +44,20 @@ Program::Program(Program&& rvalue)
 Program::~Program() {
     if (m_glId != 0) {
         glDeleteProgram(m_glId);
+        GlState::forgetProgram(m_glId);
         m_glId = 0;
     }
 }
 
 void Program::useProgram() {
-    glCall(glUseProgram(m_glId));
+    GlState::useProgram(m_glId);
     useUniformData();
 }
 
+void Program::setLabel(std::string_view label) const {
+    GlDebugOutput::label(GL_PROGRAM, m_glId, label);
+}
+
 const VertexShader& Program::getVertShader() const{
     return m_vert;
 }
@@ -58,20 +75,18 @@ GLint Program::getUniformLocation(const char* name) {
 template<typename T>
 void Program::setUniformData(const char* name, GLenum glType,size_t count ,T* data){    
 
-    Program::UniformData* p_ud;
+    auto it = m_uniformIndices.find(std::string_view(name));
+    // Not an active uniform (unknown or optimized out by the linker), same as a -1 location
+    if (it == m_uniformIndices.end())
+        return;
 
-    if (m_uniformPool.contains(name)){
-        p_ud = &m_uniformPool[name];
-    }else{
-        m_uniformPool[name] = Program::UniformData();
-        p_ud = &m_uniformPool[name];
-        p_ud->glLocation = getUniformLocation(name);
-    }
-    
-    p_ud->glType = glType;
-    p_ud->count = count;
-    p_ud->data =(byte*) (new T[count]);
-    memcpy(p_ud->data,data,count*sizeof(T));
+    checkUniformType(m_uniformPool[it->second], glType, count, name);
+    writeUniformData(it->second, count, data);
+}
+
+void Program::checkUniformType(const UniformData& ud, GLenum glType, size_t count, const char* name){
+    if (ud.count != count || (glType == GL_FLOAT) != (ud.glType == GL_FLOAT))
+        throw std::runtime_error(std::string("Uniform type mismatch for ") + name);
 }
 // Uniform 1 
 void Program::setUniform1b(const char* name, bool value)         { setUniformData(name, GL_BOOL,1,&value);}
@@ -137,53 +152,77 @@ void Program::setUniformMat4fv(const char* name, float matrix[16]) {
 }
 
 void Program::setUniformTexture2D(const char* name,Texture& texture){
+    setSamplerTexture(name, GL_TEXTURE_2D, texture.getGlId());
+}
 
-    TextureData td = {
-        std::string(name),
-        texture.getGlId(),
-    };
-    m_texturePool.push_back(td);
+void Program::setUniformTexture2DArray(const char* name,const TextureArray& textures){
+    setSamplerTexture(name, GL_TEXTURE_2D_ARRAY, textures.getGlId());
+}
+
+void Program::setSamplerTexture(const char* name, GLenum target, GLuint textureId){
+    auto it = m_samplerIndices.find(std::string_view(name));
+    // unused samplers are optimized out, same as a -1 uniform location
+    if (it == m_samplerIndices.end())
+        return;
+
+    SamplerBinding& sampler = m_samplers[it->second];
+    if (sampler.target != target)
+        throw std::runtime_error(std::string("Sampler type mismatch for uniform: ") + name);
+    sampler.textureId = textureId;
+}
+
+void Program::bindUniformBlock(const char* blockName, GLuint bindingPoint){
+    GLuint blockIndex = glCall(glGetUniformBlockIndex(m_glId, blockName));
+    // Not an active block, same as a -1 uniform location
+    if (blockIndex == GL_INVALID_INDEX)
+        return;
+
+    glCall(glUniformBlockBinding(m_glId, blockIndex, bindingPoint));
 }
 
 void Program::useUniformData(){
-    //regular uniform types
-    for(auto& key_value : m_uniformPool){
-        const UniformData& ud = key_value.second; 
+    //regular uniform types, only the ones set to a new value since the last upload
+    size_t sent = 0;
+    for(size_t index : m_dirtyUniforms){
+        UniformData& ud = m_uniformPool[index];
+        ud.dirty = false;
+
+        const byte* data = m_uniformArena.data() + ud.offset;
+        byte* uploaded = m_uploadedArena.data() + ud.offset;
+        const size_t size = ud.count * sizeof(GLint);
+        if (memcmp(data, uploaded, size) == 0)
+            continue;
+        memcpy(uploaded, data, size);
+        sent++;
+
         switch (ud.count)
         {
-        case 1 :useUniformData1(ud.glLocation, ud.glType, ud.data);  break;
-        case 2 :useUniformData2(ud.glLocation, ud.glType, ud.data);  break;
-        case 3 :useUniformData3(ud.glLocation, ud.glType, ud.data);  break;
-        case 4 :useUniformData4(ud.glLocation, ud.glType, ud.data);  break;
-        case 9 :useUniformData9(ud.glLocation, ud.glType, ud.data);  break;
-        case 16:useUniformData16(ud.glLocation, ud.glType, ud.data); break;
+        case 1 :useUniformData1(ud.glLocation, ud.glType, data);  break;
+        case 2 :useUniformData2(ud.glLocation, ud.glType, data);  break;
+        case 3 :useUniformData3(ud.glLocation, ud.glType, data);  break;
+        case 4 :useUniformData4(ud.glLocation, ud.glType, data);  break;
+        case 9 :useUniformData9(ud.glLocation, ud.glType, data);  break;
+        case 16:useUniformData16(ud.glLocation, ud.glType, data); break;
         default:
             break;
         }
     }
+    m_dirtyUniforms.clear();
 
-    // Textures
-    GLint max_textures = 0;
-    glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_textures);
-
-    unsigned int numTexture = 0;
-    for (TextureData& td : m_texturePool) {
-        if (numTexture >= (unsigned int)max_textures) break;
-
-        GLint glLoc = glCall(glGetUniformLocation(m_glId, td.name.c_str()));
-        if (glLoc == -1) continue;
-
-        glCall(glActiveTexture(GL_TEXTURE0 + numTexture));
-        glCall(glBindTexture(GL_TEXTURE_2D, td.glId));
-        glCall(glUniform1i(glLoc, numTexture));
+    m_uploadStats.sent += sent;
+    m_uploadStats.skipped += m_uniformPool.size() - sent;
 
-        numTexture++;
+    // Textures, the sampler uniforms already point at their unit
+    for (const SamplerBinding& sampler : m_samplers) {
+        if (sampler.textureId == 0)
+            continue;
+        GlState::bindTexture(sampler.unit, sampler.target, sampler.textureId);
     }
 }
 
 //Type suported : GL_BOOL, GL_INT, GL_UNSIGNED_INT, GL_FLOAT
 
-void Program::useUniformData1(GLuint glLocation, GLenum glType, byte* data) {
+void Program::useUniformData1(GLint glLocation, GLenum glType, const byte* data) {
     switch (glType) {
     case GL_BOOL:
     case GL_INT:
@@ -198,11 +237,9 @@ void Program::useUniformData1(GLuint glLocation, GLenum glType, byte* data) {
     default:
         throw std::runtime_error("Unsupported glType for 1-component uniform");
     }
-
-    throwOnGlError("Error in useUniformData 1");
 }
 
-void Program::useUniformData2(GLuint glLocation, GLenum glType, byte* data) {
+void Program::useUniformData2(GLint glLocation, GLenum glType, const byte* data) {
     switch (glType) {
     case GL_BOOL:
     case GL_INT:
@@ -217,11 +254,9 @@ void Program::useUniformData2(GLuint glLocation, GLenum glType, byte* data) {
     default:
         throw std::runtime_error("Unsupported glType for 2-component uniform");
     }
-
-    throwOnGlError("Error in useUniformData 2");
 }
 
-void Program::useUniformData3 (GLuint glLocation,GLenum glType, byte* data){
+void Program::useUniformData3 (GLint glLocation,GLenum glType, const byte* data){
     switch (glType) {
     case GL_BOOL:
     case GL_INT:
@@ -236,9 +271,8 @@ void Program::useUniformData3 (GLuint glLocation,GLenum glType, byte* data){
     default:
         throw std::runtime_error("Unsupported glType for 3-component uniform");
     }
-    throwOnGlError("Error in useUniformData3");
 }
-void Program::useUniformData4 (GLuint glLocation,GLenum glType, byte* data){
+void Program::useUniformData4 (GLint glLocation,GLenum glType, const byte* data){
     switch (glType) {
     case GL_BOOL:
     case GL_INT:
@@ -253,33 +287,35 @@ void Program::useUniformData4 (GLuint glLocation,GLenum glType, byte* data){
     default:
         throw std::runtime_error("Unsupported glType for 4-component uniform");
     }
-    throwOnGlError("Error in useUniformData4");
-
 }
 
-void Program::useUniformData9(GLuint glLocation, GLenum glType, byte* data) {
+void Program::useUniformData9(GLint glLocation, GLenum glType, const byte* data) {
     if (glType == GL_FLOAT) {
         glUniformMatrix3fv(glLocation, 1, GL_FALSE, (const float*)(data));
     } else {
         throw std::runtime_error("Unsupported non-float 3x3 uniform");
     }
-    throwOnGlError("Error in useUniformData9");
 }
 
-void Program::useUniformData16(GLuint glLocation, GLenum glType, byte* data) {
+void Program::useUniformData16(GLint glLocation, GLenum glType, const byte* data) {
     if (glType == GL_FLOAT) {
         glUniformMatrix4fv(glLocation, 1, GL_FALSE, (const float*)(data));
     } else {
         throw std::runtime_error("Unsupported non-float 4x4 uniform");
     }
-    throwOnGlError("Error in useUniformData16");
 }
 
 
 
 void Program::clearUniforms(){
-    m_uniformPool.clear();
-    m_texturePool.clear();
+    std::fill(m_uniformArena.begin(), m_uniformArena.end(), byte{0});
+    m_dirtyUniforms.clear();
+    for (size_t i = 0; i < m_uniformPool.size(); i++) {
+        m_uniformPool[i].dirty = true;
+        m_dirtyUniforms.push_back(i);
+    }
+    for (SamplerBinding& sampler : m_samplers)
+        sampler.textureId = 0;
 }
 
 void Program::attachGlShader(GLint glProgramId, VertexShader& vs, FragmentShader& fs){
@@ -299,3 +335,123 @@ void Program::attachGlShader(GLint glProgramId, VertexShader& vs, FragmentShader
         throw error;
     }
 }
+
+// Builds the uniform arena from the active uniforms of the linked program,
+// each uniform gets a fixed slot so setting it never allocates
+void Program::reflectUniforms(){
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    glCall(glGetProgramiv(m_glId, GL_ACTIVE_UNIFORMS, &uniformCount));
+    glCall(glGetProgramiv(m_glId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength));
+
+    std::string nameBuffer(maxNameLength, '\0');
+    size_t arenaSize = 0;
+
+    for (GLint i = 0; i < uniformCount; i++) {
+        GLsizei nameLength = 0;
+        GLint arraySize = 0;
+        GLenum glUniformType = 0;
+        glCall(glGetActiveUniform(m_glId, i, maxNameLength, &nameLength, &arraySize, &glUniformType, nameBuffer.data()));
+
+        // arrays are reported once as "name[0]", give every element its own slot
+        std::string name(nameBuffer.data(), nameLength);
+        if (arraySize > 1 && name.ends_with("[0]"))
+            name.resize(name.size() - 3);
+
+        GLenum target = samplerTarget(glUniformType);
+        if (target != 0) {
+            for (GLint element = 0; element < arraySize; element++) {
+                std::string elementName = arraySize > 1 ? name + '[' + std::to_string(element) + ']' : name;
+
+                GLint glLocation = glCall(glGetUniformLocation(m_glId, elementName.c_str()));
+                m_samplerIndices[elementName] = m_samplers.size();
+                m_samplers.push_back({glLocation, target, static_cast<GLuint>(m_samplers.size()), 0});
+            }
+            continue;
+        }
+
+        UniformData ud;
+        if (!uniformComponents(glUniformType, ud.glType, ud.count))
+            continue;
+
+        for (GLint element = 0; element < arraySize; element++) {
+            std::string elementName = arraySize > 1 ? name + '[' + std::to_string(element) + ']' : name;
+
+            ud.glLocation = glCall(glGetUniformLocation(m_glId, elementName.c_str()));
+            if (ud.glLocation == -1)
+                continue; // uniform block members have no location
+
+            ud.offset = arenaSize;
+            ud.dirty = false;
+            arenaSize += ud.count * sizeof(GLint);
+            m_uniformIndices[elementName] = m_uniformPool.size();
+            m_uniformPool.push_back(ud);
+        }
+    }
+
+    // a freshly linked program has all its uniforms set to zero
+    m_uniformArena.assign(arenaSize, byte{0});
+    m_uploadedArena.assign(arenaSize, byte{0});
+    m_dirtyUniforms.reserve(m_uniformPool.size());
+
+    assignTextureUnits();
+}
+
+void Program::assignTextureUnits(){
+    if (m_samplers.empty())
+        return;
+
+    GLint maxUnits = 0;
+    glCall(glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxUnits));
+    if (m_samplers.size() > (size_t)maxUnits)
+        throw std::runtime_error("Program uses more samplers than GL_MAX_TEXTURE_IMAGE_UNITS");
+
+    // sampler values are program state, they only need to be set once
+    GlState::useProgram(m_glId);
+    for (const SamplerBinding& sampler : m_samplers) {
+        glCall(glUniform1i(sampler.glLocation, sampler.unit));
+    }
+}
+
+// @returns the texture target a sampler type binds to, 0 if not a sampler
+GLenum Program::samplerTarget(GLenum glUniformType){
+    switch (glUniformType) {
+    case GL_SAMPLER_1D:         return GL_TEXTURE_1D;
+    case GL_SAMPLER_2D:         return GL_TEXTURE_2D;
+    case GL_SAMPLER_3D:         return GL_TEXTURE_3D;
+    case GL_SAMPLER_CUBE:       return GL_TEXTURE_CUBE_MAP;
+    case GL_SAMPLER_2D_ARRAY:   return GL_TEXTURE_2D_ARRAY;
+    case GL_SAMPLER_2D_SHADOW:  return GL_TEXTURE_2D;
+    default:                    return 0;
+    }
+}
+
+// Splits a glGetActiveUniform type into the component type and count used by useUniformData
+// @returns false for unsupported types
+bool Program::uniformComponents(GLenum glUniformType, GLenum& glType, size_t& count){
+    switch (glUniformType) {
+    case GL_FLOAT:              glType = GL_FLOAT; count = 1; return true;
+    case GL_FLOAT_VEC2:         glType = GL_FLOAT; count = 2; return true;
+    case GL_FLOAT_VEC3:         glType = GL_FLOAT; count = 3; return true;
+    case GL_FLOAT_VEC4:         glType = GL_FLOAT; count = 4; return true;
+    case GL_FLOAT_MAT3:         glType = GL_FLOAT; count = 9; return true;
+    case GL_FLOAT_MAT4:         glType = GL_FLOAT; count = 16; return true;
+
+    case GL_INT:                glType = GL_INT; count = 1; return true;
+    case GL_INT_VEC2:           glType = GL_INT; count = 2; return true;
+    case GL_INT_VEC3:           glType = GL_INT; count = 3; return true;
+    case GL_INT_VEC4:           glType = GL_INT; count = 4; return true;
+
+    case GL_UNSIGNED_INT:       glType = GL_UNSIGNED_INT; count = 1; return true;
+    case GL_UNSIGNED_INT_VEC2:  glType = GL_UNSIGNED_INT; count = 2; return true;
+    case GL_UNSIGNED_INT_VEC3:  glType = GL_UNSIGNED_INT; count = 3; return true;
+    case GL_UNSIGNED_INT_VEC4:  glType = GL_UNSIGNED_INT; count = 4; return true;
+
+    case GL_BOOL:               glType = GL_BOOL; count = 1; return true;
+    case GL_BOOL_VEC2:          glType = GL_BOOL; count = 2; return true;
+    case GL_BOOL_VEC3:          glType = GL_BOOL; count = 3; return true;
+    case GL_BOOL_VEC4:          glType = GL_BOOL; count = 4; return true;
+
+    default: return false;
+    }
+}
@@ -0,0 +1,157 @@
+#include "RenderQueue.hpp"
+
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "GlState.hpp"
+
+// -- Private utils --
+
+namespace {
+
+constexpr int DEPTH_BITS = 24;
+constexpr int PROGRAM_BITS = 10;
+constexpr int TEXTURE_BITS = 12;
+constexpr int VERTEX_ARRAY_BITS = 12;
+constexpr int UNUSED_BITS = 5;
+
+constexpr uint64_t DEPTH_MASK = (uint64_t(1) << DEPTH_BITS) - 1;
+constexpr uint64_t TRANSPARENT_BIT = uint64_t(1) << 63;
+
+// The bits of a positive float sort like the float, the 24 high bits (the
+// sign bit is always 0) keep the exponent and 16 bits of mantissa
+uint64_t quantizeDepth(float depth) {
+    if (!(depth > 0.0f))
+        return 0;
+    return (std::bit_cast<uint32_t>(depth) >> (32 - 1 - DEPTH_BITS)) & DEPTH_MASK;
+}
+
+// @returns the index of object, a new one on first sight
+template <typename K>
+uint64_t denseIndex(std::unordered_map<K, uint64_t>& indices, K object, size_t max, const char* error) {
+    auto [it, inserted] = indices.try_emplace(object, indices.size());
+    if (inserted && it->second >= max) {
+        indices.erase(it);
+        throw std::runtime_error(error);
+    }
+    return it->second;
+}
+
+} // namespace
+
+// -- Methods --
+void RenderQueue::submit(const DrawSubmission& submission) {
+    uint64_t key = makeKey(submission);
+    m_items.push_back({key, static_cast<uint32_t>(m_submissions.size())});
+    m_submissions.push_back(submission);
+}
+
+void RenderQueue::flush() {
+    m_stats = RenderQueueStats();
+    radixSort(m_items, m_scratch);
+
+    const Program* program = nullptr;
+    const VertexArray* vertexArray = nullptr;
+    GLuint texture = 0;
+    bool blending = false;
+
+    for (const SortItem& item : m_items) {
+        DrawSubmission& draw = m_submissions[item.index];
+
+        if (draw.transparent && !blending) {
+            // opaque draws are done, the transparent ones blend over them
+            GlState::setEnabled(GL_BLEND, true);
+            GlState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            GlState::depthMask(GL_FALSE);
+            blending = true;
+        }
+
+        if (draw.program != program) {
+            draw.program->useProgram();
+            program = draw.program;
+            texture = 0;
+            m_stats.programChanges++;
+        }
+        if (draw.texture != 0 && draw.texture != texture) {
+            GlState::bindTexture(draw.textureUnit, draw.textureTarget, draw.texture);
+            texture = draw.texture;
+            m_stats.textureChanges++;
+        }
+        if (draw.vertexArray != vertexArray) {
+            m_stats.vertexArrayChanges++;
+            vertexArray = draw.vertexArray;
+        }
+
+        if (draw.instanceCount > 0)
+            draw.vertexArray->drawInstanced(draw.instanceCount, draw.mode);
+        else
+            draw.vertexArray->draw(draw.mode);
+        m_stats.draws++;
+    }
+
+    if (blending) {
+        GlState::setEnabled(GL_BLEND, false);
+        GlState::depthMask(GL_TRUE);
+    }
+
+    m_submissions.clear();
+    m_items.clear();
+}
+
+// -- Private methods --
+uint64_t RenderQueue::makeKey(const DrawSubmission& submission) {
+    uint64_t program = denseIndex<const Program*>(m_programIndices, submission.program, MAX_PROGRAMS,
+                                                  "ERROR::RENDER_QUEUE::TOO_MANY_PROGRAMS");
+    uint64_t texture = denseIndex<GLuint>(m_textureIndices, submission.texture, MAX_TEXTURES,
+                                          "ERROR::RENDER_QUEUE::TOO_MANY_TEXTURES");
+    uint64_t vertexArray = denseIndex<const VertexArray*>(m_vertexArrayIndices, submission.vertexArray,
+                                                          MAX_VERTEX_ARRAYS,
+                                                          "ERROR::RENDER_QUEUE::TOO_MANY_VERTEX_ARRAYS");
+    uint64_t depth = quantizeDepth(submission.depth);
+
+    uint64_t state = (program << (TEXTURE_BITS + VERTEX_ARRAY_BITS)) | (texture << VERTEX_ARRAY_BITS) | vertexArray;
+    constexpr int STATE_BITS = PROGRAM_BITS + TEXTURE_BITS + VERTEX_ARRAY_BITS;
+
+    if (!submission.transparent)
+        return (state << (DEPTH_BITS + UNUSED_BITS)) | (depth << UNUSED_BITS);
+
+    // far first
+    uint64_t farFirst = DEPTH_MASK - depth;
+    return TRANSPARENT_BIT | (farFirst << (STATE_BITS + UNUSED_BITS)) | (state << UNUSED_BITS);
+}
+
+void RenderQueue::radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch) {
+    constexpr int DIGIT_BITS = 8;
+    constexpr size_t BUCKETS = size_t(1) << DIGIT_BITS;
+    constexpr int PASSES = 64 / DIGIT_BITS;
+
+    if (items.size() < 2)
+        return;
+    scratch.resize(items.size());
+
+    // one read of the keys builds every histogram
+    size_t counts[PASSES][BUCKETS];
+    std::memset(counts, 0, sizeof(counts));
+    for (const SortItem& item : items)
+        for (int pass = 0; pass < PASSES; pass++)
+            counts[pass][(item.key >> (pass * DIGIT_BITS)) & (BUCKETS - 1)]++;
+
+    for (int pass = 0; pass < PASSES; pass++) {
+        size_t* count = counts[pass];
+        const int shift = pass * DIGIT_BITS;
+
+        // every key has the same digit, the pass would not move anything
+        if (count[(items[0].key >> shift) & (BUCKETS - 1)] == items.size())
+            continue;
+
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < BUCKETS; bucket++)
+            offset += std::exchange(count[bucket], offset);
+
+        for (const SortItem& item : items)
+            scratch[count[(item.key >> shift) & (BUCKETS - 1)]++] = item;
+        items.swap(scratch);
+    }
+}
@@ -1,28 +1,28 @@
 #include "Texture.hpp"
 
-#include <cstring>
+#include <stdexcept>
+#include <string>
 
-#include "macros.hpp"
+#include "GlDebug.hpp"
+#include "GlState.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
-using std::memcpy;
-
-
 // -- Constructors --
-Texture::Texture(GLint internalformat,GLsizei width,GLsizei height,GLenum format,const std::vector<unsigned char> data ):
+Texture::Texture(GLint internalformat,GLsizei width,GLsizei height,GLenum format,const std::vector<unsigned char>& data ):
+    Texture(internalformat,width,height,format,data.data())
+    {}
+
+Texture::Texture(GLint internalformat,GLsizei width,GLsizei height,GLenum format,const unsigned char* data ):
     m_glId(0),
     m_internalformat(internalformat),
     m_width(width),
     m_height(height),
-    m_format(format),
-    m_data(data)
-    {}
-
-Texture::Texture(GLint internalformat,GLsizei width,GLsizei height,GLenum format,const unsigned char* data ):
-    Texture(internalformat,width,height,format,std::vector<unsigned char>(data, data + (size_t)(width*height) * bytePerPixel(format, GL_UNSIGNED_BYTE)))
-    {}
+    m_format(format)
+    {
+        createGlTexture(data);
+    }
 
 Texture& Texture::operator=(Texture&& other) noexcept{
     if(this != &other){
@@ -34,10 +34,7 @@ Texture& Texture::operator=(Texture&& other) noexcept{
         m_height = other.m_height;
         m_format = other.m_format;
 
-        m_data = std::move(other.m_data);
-
         other.m_glId = 0;
-        other.m_data = std::vector<unsigned char>();
     }
 
     return *this;
@@ -47,29 +44,49 @@ Texture::Texture(Texture&& other) noexcept:
     m_internalformat(other.m_internalformat),
     m_width(other.m_width),
     m_height(other.m_height),
-    m_format(other.m_format),
-    m_data(other.m_data)
+    m_format(other.m_format)
     {
         other.m_glId = 0;
-        other.m_data = std::vector<unsigned char>();
     }
 
 
-Texture::Texture(const char* path,GLint internalFormat,GLint format){
-    stbi_set_flip_vertically_on_load(true);
+Texture::Texture(const char* path,GLint internalFormat,GLint format):
+    m_glId(0),
+    m_internalformat(internalFormat),
+    m_format(format)
+{
+    DecodedImage image = decodeImage(path, format);
+    m_width = image.width;
+    m_height = image.height;
+
+    // straight from the stbi buffer to GL, freed at the end of the scope
+    createGlTexture(image.pixels.get());
+}
 
-    int width, height, _nrChannels;
-    unsigned char* data = stbi_load(path, &width, &height, &_nrChannels, 0);
-    expect_ptr(data,"could not load the image :" << path, -1);
 
-    m_glId = 0;
-    m_internalformat = internalFormat;
-    m_width= width;
-    m_height = height;
-    m_format = format;
-    m_data = std::vector<unsigned char>(data, data + (size_t)(width*height) * bytePerPixel(format, GL_UNSIGNED_BYTE));
+Texture::Texture(const DdsFile& file):
+    m_glId(0),
+    m_internalformat(file.getInternalFormat()),
+    m_width(file.getWidth()),
+    m_height(file.getHeight()),
+    m_format(GL_RGBA)
+{
+    glGenTextures(1,&m_glId);
+    if(!m_glId)
+        throw "ERROR::TEXTURE::CREATION_FAILED \n";
+
+    GlState::bindTexture(GL_TEXTURE_2D,m_glId);
+    // the levels are read from the file mapping, not from a pixel unpack
+    // buffer the texture streaming may have left bound
+    GlState::bindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
 
-    stbi_image_free(data);
+    // the mip chain comes from the file, no glGenerateMipmap
+    const std::vector<DdsLevel>& levels = file.getLevels();
+    for(size_t level = 0; level < levels.size(); level++){
+        const DdsLevel& l = levels[level];
+        glCall(glCompressedTexImage2D(GL_TEXTURE_2D, level, m_internalformat, l.width, l.height, 0, l.size, l.data));
+    }
+    glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels.size() - 1));
 }
 
 
@@ -79,35 +96,81 @@ Texture::~Texture(){
 }
 
 // -- Getters --
-GLuint Texture::getGlId(){
-    if(m_glId == 0)
-        createGlTexture();    
+GLuint Texture::getGlId() const{
     return m_glId;
 }
 
+void Texture::setLabel(std::string_view label) const{
+    GlDebugOutput::label(GL_TEXTURE,m_glId,label);
+}
+
 // -- Public methods --
 void Texture::deleteGlTexture(){
-    if(m_glId != 0)
+    if(m_glId != 0){
         glDeleteTextures(1,&m_glId);
+        GlState::forgetTexture(m_glId);
+    }
     m_glId = 0;
 }
 
+void Texture::setImage(GLsizei width, GLsizei height, const unsigned char* data){
+    // the storage is only reallocated when the size changes
+    bool sameSize = m_width == width && m_height == height;
+    m_width = width;
+    m_height = height;
+
+    GlState::bindTexture(GL_TEXTURE_2D,m_glId);
+    // rows coming from stbi or a vector are tightly packed
+    glCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    if(sameSize){
+        glCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, m_format, GL_UNSIGNED_BYTE, data));
+    }else{
+        glCall(glTexImage2D(GL_TEXTURE_2D, 0, m_internalformat, m_width, m_height, 0, m_format, GL_UNSIGNED_BYTE, data));
+    }
+    glCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+    glCall(glGenerateMipmap(GL_TEXTURE_2D));
+}
+
 // -- Private methods --
 
-void Texture::createGlTexture(){
+void Texture::createGlTexture(const unsigned char* data){
 
     glGenTextures(1,&m_glId);
     if(!m_glId)
         throw "ERROR::TEXTURE::CREATION_FAILED \n";
     
-    glBindTexture(GL_TEXTURE_2D,m_glId);
-    glTexImage2D(GL_TEXTURE_2D, 0, m_internalformat, m_width, m_height, 0, m_format, GL_UNSIGNED_BYTE, m_data.data());
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    throwOnGlError("Error while creating a glTexture");
+    // no storage yet, force the glTexImage2D path
+    GLsizei width = m_width, height = m_height;
+    m_width = m_height = 0;
+    setImage(width, height, data);
 }
 
 // -- Utils --
+void StbiDeleter::operator()(unsigned char* pixels) const{
+    stbi_image_free(pixels);
+}
+
+DecodedImage Texture::decodeImage(const char* path, GLenum format){
+    // the global flag would race between loader threads
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    // ask stbi for the channel count of `format` so the buffer always holds
+    // what glTexImage2D is going to read
+    int channels = (int)bytePerPixel(format, GL_UNSIGNED_BYTE);
+    int width, height, _nrChannels;
+    DecodedImage image{
+        std::unique_ptr<unsigned char, StbiDeleter>(stbi_load(path, &width, &height, &_nrChannels, channels)),
+        0, 0, 0
+    };
+    if(!image.pixels)
+        throw std::runtime_error(std::string("ERROR::TEXTURE::LOAD_FAILED ") + path + " : " + stbi_failure_reason());
+
+    image.width = width;
+    image.height = height;
+    image.size = (size_t)width * height * channels;
+    return image;
+}
+
 constexpr size_t Texture::bytePerPixel(GLenum format, GLenum type){
     
     size_t channels = 1;
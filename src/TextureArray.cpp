@@ -0,0 +1,109 @@
+#include "TextureArray.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "GlDebug.hpp"
+#include "GlState.hpp"
+#include "gl_utils.hpp"
+
+// -- Constructors --
+TextureArray::TextureArray(GLsizei layerCount, GLint internalFormat)
+    : m_glId(0), m_internalFormat(internalFormat), m_width(1), m_height(1), m_uvScales(layerCount, glm::vec2(1.0f)) {
+    if (layerCount <= 0)
+        throw std::runtime_error("ERROR::TEXTURE_ARRAY::NO_LAYER");
+
+    // opaque black, a 1x1 level is a complete mip chain on its own
+    std::vector<unsigned char> placeholder(size_t(layerCount) * BYTES_PER_PIXEL, 0);
+    for (size_t alpha = 3; alpha < placeholder.size(); alpha += BYTES_PER_PIXEL)
+        placeholder[alpha] = 255;
+
+    glCall(glGenTextures(1, &m_glId));
+    GlState::bindTexture(GL_TEXTURE_2D_ARRAY, m_glId);
+    glCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, m_internalFormat, 1, 1, layerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                        placeholder.data()));
+
+    glCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    glCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    glCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+    glCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+}
+
+TextureArray::TextureArray(TextureArray&& other) noexcept
+    : m_glId(other.m_glId),
+      m_internalFormat(other.m_internalFormat),
+      m_width(other.m_width),
+      m_height(other.m_height),
+      m_uvScales(std::move(other.m_uvScales)) {
+    other.m_glId = 0;
+}
+
+TextureArray& TextureArray::operator=(TextureArray&& other) noexcept {
+    if (this != &other) {
+        if (m_glId != 0) {
+            glDeleteTextures(1, &m_glId);
+            GlState::forgetTexture(m_glId);
+        }
+
+        m_glId = other.m_glId;
+        m_internalFormat = other.m_internalFormat;
+        m_width = other.m_width;
+        m_height = other.m_height;
+        m_uvScales = std::move(other.m_uvScales);
+        other.m_glId = 0;
+    }
+    return *this;
+}
+
+// -- Destructor --
+TextureArray::~TextureArray() {
+    if (m_glId != 0) {
+        glDeleteTextures(1, &m_glId);
+        GlState::forgetTexture(m_glId);
+    }
+}
+
+// -- Methods --
+void TextureArray::allocate(GLsizei width, GLsizei height) {
+    m_width = width;
+    m_height = height;
+
+    // the old mip levels no longer match level 0, the array is incomplete
+    // (black) until generateMipmaps()
+    GlState::bindTexture(GL_TEXTURE_2D_ARRAY, m_glId);
+    glCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, m_internalFormat, m_width, m_height, getLayerCount(), 0, GL_RGBA,
+                        GL_UNSIGNED_BYTE, nullptr));
+}
+
+void TextureArray::setLayer(GLint layer, GLsizei imageWidth, GLsizei imageHeight, const unsigned char* pixels) {
+    GlState::bindTexture(GL_TEXTURE_2D_ARRAY, m_glId);
+    glCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_width, m_height, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                           pixels));
+    m_uvScales[layer] = glm::vec2(float(imageWidth) / m_width, float(imageHeight) / m_height);
+}
+
+void TextureArray::generateMipmaps() {
+    GlState::bindTexture(GL_TEXTURE_2D_ARRAY, m_glId);
+    glCall(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+}
+
+void TextureArray::setLabel(std::string_view label) const {
+    GlDebugOutput::label(GL_TEXTURE, m_glId, label);
+}
+
+// -- Utils --
+void TextureArray::padImage(const DecodedImage& image, GLsizei width, GLsizei height, unsigned char* layer) {
+    const unsigned char* pixels = image.pixels.get();
+
+    for (GLsizei y = 0; y < height; y++) {
+        const unsigned char* sourceRow =
+            pixels + size_t(std::min(y, image.height - 1)) * image.width * BYTES_PER_PIXEL;
+        unsigned char* row = layer + size_t(y) * width * BYTES_PER_PIXEL;
+
+        std::memcpy(row, sourceRow, size_t(image.width) * BYTES_PER_PIXEL);
+        const unsigned char* edge = sourceRow + size_t(image.width - 1) * BYTES_PER_PIXEL;
+        for (GLsizei x = image.width; x < width; x++)
+            std::memcpy(row + size_t(x) * BYTES_PER_PIXEL, edge, BYTES_PER_PIXEL);
+    }
+}
@@ -0,0 +1,204 @@
+#include "TextureLoader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+// -- Private utils --
+
+namespace {
+
+template <typename T>
+bool isReady(const std::future<T>& future) {
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+} // namespace
+
+// -- Constructors --
+TextureLoader::TextureLoader(ThreadPool& pool, size_t ringSlots)
+    : m_pool(pool), m_ring(ringSlots), m_pendingTextures(), m_pendingArrays() {}
+
+// -- Destructor --
+TextureLoader::~TextureLoader() {
+    for (PendingTexture& pending : m_pendingTextures)
+        if (pending.copying.valid())
+            pending.copying.wait();
+    for (PendingArray& pending : m_pendingArrays)
+        for (LayerCopy& copy : pending.copies)
+            copy.copying.wait();
+}
+
+// -- Methods --
+void TextureLoader::load(Texture& target, const char* path) {
+    GLenum format = target.getFormat();
+    std::string imagePath(path);
+
+    // the job gets its own copy of the path, the caller's may not live long
+    std::future<DecodedImage> decoding =
+        m_pool.submit([imagePath, format]() { return Texture::decodeImage(imagePath.c_str(), format); });
+
+    m_pendingTextures.push_back({&target, std::move(decoding), DecodedImage{}, -1, std::future<void>()});
+}
+
+void TextureLoader::load(TextureArray& target, const std::vector<std::string>& paths) {
+    if (paths.size() != size_t(target.getLayerCount()))
+        throw std::runtime_error("ERROR::TEXTURE_LOADER::LAYER_COUNT_MISMATCH");
+
+    PendingArray pending{&target, {}, {}, 0, {}, 0};
+    // each job gets its own copy of the path, the caller's may not live long
+    for (const std::string& path : paths)
+        pending.decoding.push_back(
+            m_pool.submit([path]() { return Texture::decodeImage(path.c_str(), GL_RGBA); }));
+
+    m_pendingArrays.push_back(std::move(pending));
+}
+
+size_t TextureLoader::uploadReady() {
+    return advanceAll(m_pendingTextures) + advanceAll(m_pendingArrays);
+}
+
+void TextureLoader::uploadAll() {
+    while (getPendingCount() > 0) {
+        uploadReady();
+        std::this_thread::yield();
+    }
+}
+
+// -- Private methods --
+template <typename Pending>
+size_t TextureLoader::advanceAll(std::vector<Pending>& pending) {
+    size_t uploaded = 0;
+
+    for (size_t i = 0; i < pending.size();) {
+        bool done;
+        try {
+            done = advance(pending[i]);
+        } catch (...) {
+            // a failed decode drops its request, the target keeps its placeholder
+            remove(pending, i);
+            throw;
+        }
+        if (!done) {
+            i++;
+            continue;
+        }
+        uploaded++;
+        remove(pending, i);
+    }
+    return uploaded;
+}
+
+bool TextureLoader::advance(PendingTexture& pending) {
+    // decoding
+    if (pending.decoding.valid()) {
+        if (!isReady(pending.decoding))
+            return false;
+        pending.image = pending.decoding.get();
+    }
+
+    // waiting for a slot, then filling it from a worker
+    if (pending.slot < 0) {
+        pending.slot = m_ring.acquire(pending.image.size);
+        if (pending.slot < 0)
+            return false;
+
+        GLubyte* destination = m_ring.getMapped(pending.slot);
+        pending.copying = m_pool.submit(
+            [destination, size = pending.image.size, pixels = pending.image.pixels.get()]() {
+                std::memcpy(destination, pixels, size);
+            });
+        return false;
+    }
+
+    // copy into the texture from the slot
+    if (!isReady(pending.copying))
+        return false;
+    pending.copying.get();
+
+    m_ring.upload(pending.slot, *pending.target, pending.image.width, pending.image.height);
+    return true;
+}
+
+bool TextureLoader::advance(PendingArray& pending) {
+    TextureArray& target = *pending.target;
+
+    // decoding, the layer size is only known once every image is
+    if (!pending.decoding.empty()) {
+        for (const std::future<DecodedImage>& decoding : pending.decoding)
+            if (!isReady(decoding))
+                return false;
+
+        GLsizei width = 0, height = 0;
+        for (std::future<DecodedImage>& decoding : pending.decoding) {
+            pending.images.push_back(decoding.get());
+            width = std::max(width, pending.images.back().width);
+            height = std::max(height, pending.images.back().height);
+        }
+        pending.decoding.clear();
+        target.allocate(width, height);
+    }
+
+    // waiting for slots, then padding the layers into them from workers
+    while (pending.nextLayer < pending.images.size()) {
+        int slot = m_ring.acquire(target.getLayerSize());
+        if (slot < 0)
+            break;
+
+        // images keeps its buffer when the request moves in m_pendingArrays
+        const DecodedImage& image = pending.images[pending.nextLayer];
+        GLubyte* destination = m_ring.getMapped(slot);
+        std::future<void> copying = m_pool.submit(
+            [&image, destination, width = target.getWidth(), height = target.getHeight()]() {
+                TextureArray::padImage(image, width, height, destination);
+            });
+        pending.copies.push_back({static_cast<GLint>(pending.nextLayer), slot, std::move(copying)});
+        pending.nextLayer++;
+    }
+
+    // copies into the layers from the filled slots
+    for (size_t i = 0; i < pending.copies.size();) {
+        LayerCopy& copy = pending.copies[i];
+        if (!isReady(copy.copying)) {
+            i++;
+            continue;
+        }
+        copy.copying.get();
+
+        DecodedImage& image = pending.images[copy.layer];
+        m_ring.upload(copy.slot, target, copy.layer, image.width, image.height);
+        image.pixels.reset();
+        pending.uploadedCount++;
+
+        if (i + 1 != pending.copies.size())
+            copy = std::move(pending.copies.back());
+        pending.copies.pop_back();
+    }
+
+    if (pending.uploadedCount < pending.images.size())
+        return false;
+    target.generateMipmaps();
+    return true;
+}
+
+void TextureLoader::remove(std::vector<PendingTexture>& pending, size_t index) {
+    // a worker may still be writing into the ring for this request
+    if (pending[index].copying.valid())
+        pending[index].copying.wait();
+
+    // order does not matter, the last one takes its place
+    if (index + 1 != pending.size())
+        pending[index] = std::move(pending.back());
+    pending.pop_back();
+}
+
+void TextureLoader::remove(std::vector<PendingArray>& pending, size_t index) {
+    for (LayerCopy& copy : pending[index].copies)
+        copy.copying.wait();
+
+    if (index + 1 != pending.size())
+        pending[index] = std::move(pending.back());
+    pending.pop_back();
+}
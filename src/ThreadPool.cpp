@@ -0,0 +1,43 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+// -- Constructors --
+ThreadPool::ThreadPool(size_t threadCount) : m_stopping(false) {
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++)
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+// -- Destructor --
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobAvailable.notify_all();
+
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+// -- Private methods --
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobAvailable.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+
+            if (m_jobs.empty())
+                return; // stopping and nothing left to do
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop();
+        }
+        job();
+    }
+}
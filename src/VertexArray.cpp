@@ -2,21 +2,53 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "GlDebug.hpp"
+#include "GlState.hpp"
+
 //-- Constructors --
-VertexArray::VertexArray() { glCall(glGenVertexArrays(1, &m_glId)); }
+VertexArray::VertexArray()
+    : m_attribCount(0),
+      m_vertexCount(0),
+      m_indexBuffer(),
+      m_indexType(GL_UNSIGNED_INT),
+      m_indexCount(0) {
+  glCall(glGenVertexArrays(1, &m_glId));
+}
 
-VertexArray::VertexArray(VertexArray&& other) noexcept : m_glId(other.m_glId) {
+VertexArray::VertexArray(VertexArray&& other) noexcept
+    : m_glId(other.m_glId),
+      m_attribCount(other.m_attribCount),
+      m_vertexCount(other.m_vertexCount),
+      m_indexBuffer(std::move(other.m_indexBuffer)),
+      m_indexType(other.m_indexType),
+      m_indexCount(other.m_indexCount) {
   other.m_glId = 0;
+  other.m_attribCount = 0;
+  other.m_vertexCount = 0;
+  other.m_indexCount = 0;
 }
 
 VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
   if (this != &other) {
     if (m_glId != 0) {
       glDeleteVertexArrays(1, &m_glId);
+      GlState::forgetVertexArray(m_glId);
     }
 
     m_glId = other.m_glId;
+    m_attribCount = other.m_attribCount;
+    m_vertexCount = other.m_vertexCount;
+    m_indexBuffer = std::move(other.m_indexBuffer);
+    m_indexType = other.m_indexType;
+    m_indexCount = other.m_indexCount;
     other.m_glId = 0;
+    other.m_attribCount = 0;
+    other.m_vertexCount = 0;
+    other.m_indexCount = 0;
   }
   return *this;
 }
@@ -24,11 +56,82 @@ VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
 //-- Destructor --
 VertexArray::~VertexArray() {
   glDeleteVertexArrays(1, &m_glId);
+  GlState::forgetVertexArray(m_glId);
   m_glId = 0;
 }
 
 //-- Methods --
 
-void VertexArray::bind() const { glCall(glBindVertexArray(m_glId)); }
+void VertexArray::bind() const { GlState::bindVertexArray(m_glId); }
+
+void VertexArray::unbind() const { GlState::bindVertexArray(0); }
+
+void VertexArray::setLabel(std::string_view label) const {
+  bind();
+  GlDebugOutput::label(GL_VERTEX_ARRAY, m_glId, label);
+}
+
+void VertexArray::setIndices(const GLuint* indices, size_t count) {
+  // the element buffer binding is part of the VAO state
+  bind();
+
+  const GLuint maxIndex =
+      count > 0 ? *std::max_element(indices, indices + count) : 0;
+
+  if (maxIndex <= 0xFF) {
+    std::vector<GLubyte> narrowed(indices, indices + count);
+    m_indexBuffer.emplace<IndexBuffer<GLubyte>>(narrowed.data(), count);
+    m_indexType = GL_UNSIGNED_BYTE;
+  } else if (maxIndex <= 0xFFFF) {
+    std::vector<GLushort> narrowed(indices, indices + count);
+    m_indexBuffer.emplace<IndexBuffer<GLushort>>(narrowed.data(), count);
+    m_indexType = GL_UNSIGNED_SHORT;
+  } else {
+    m_indexBuffer.emplace<IndexBuffer<GLuint>>(indices, count);
+    m_indexType = GL_UNSIGNED_INT;
+  }
+  m_indexCount = count;
+}
+
+void VertexArray::setIndices(GLenum indexType, const void* indices,
+                             size_t count) {
+  bind();
+
+  switch (indexType) {
+    case GL_UNSIGNED_BYTE:
+      m_indexBuffer.emplace<IndexBuffer<GLubyte>>(
+          static_cast<const GLubyte*>(indices), count);
+      break;
+    case GL_UNSIGNED_SHORT:
+      m_indexBuffer.emplace<IndexBuffer<GLushort>>(
+          static_cast<const GLushort*>(indices), count);
+      break;
+    case GL_UNSIGNED_INT:
+      m_indexBuffer.emplace<IndexBuffer<GLuint>>(
+          static_cast<const GLuint*>(indices), count);
+      break;
+    default:
+      throw std::runtime_error("ERROR::VERTEX_ARRAY::INVALID_INDEX_TYPE");
+  }
+  m_indexType = indexType;
+  m_indexCount = count;
+}
+
+void VertexArray::draw(GLenum mode) const {
+  bind();
+  if (m_indexCount > 0) {
+    glCall(glDrawElements(mode, m_indexCount, m_indexType, nullptr));
+  } else {
+    glCall(glDrawArrays(mode, 0, m_vertexCount));
+  }
+}
 
-void VertexArray::unbind() const { glCall(glBindVertexArray(0)); }
\ No newline at end of file
+void VertexArray::drawInstanced(GLsizei instanceCount, GLenum mode) const {
+  bind();
+  if (m_indexCount > 0) {
+    glCall(glDrawElementsInstanced(mode, m_indexCount, m_indexType, nullptr,
+                                   instanceCount));
+  } else {
+    glCall(glDrawArraysInstanced(mode, 0, m_vertexCount, instanceCount));
+  }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "Culling.hpp"
+#include "Movable.hpp"
+#include "ThreadPool.hpp"
+
+// -- Bounds --
+
+// Axis aligned box, empty (min > max) until it grows
+struct Aabb {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    void grow(glm::vec3 point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    void grow(const Aabb& box) {
+        min = glm::min(min, box.min);
+        max = glm::max(max, box.max);
+    }
+
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+    // half the area, all the SAH needs is the ratio between boxes
+    float getHalfArea() const {
+        glm::vec3 size = max - min;
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+
+    // Box around this one once transformed (Arvo's method)
+    Aabb transformed(const glm::mat4& transform) const;
+};
+
+// World bounds of a mesh with local bounds `local` placed by `movable`,
+// the unit cube by default
+Aabb worldBounds(const Movable& movable, const Aabb& local = Aabb{glm::vec3(-0.5f), glm::vec3(0.5f)});
+
+// -- BVH --
+
+struct RayHit {
+    uint32_t primitive;
+    float distance; // along the ray direction, in its units
+};
+
+// Bounding volume hierarchy over primitive bounds, built with binned SAH.
+// Nodes live in one array, 32 bytes each: a parent always comes before its
+// children and siblings are adjacent, so a node stores either its first
+// child or its first primitive, and refitting is one backward pass. Every
+// subtree covers a contiguous range of the primitive indices.
+// Queries test the primitive bounds, not their meshes.
+class Bvh
+{
+public:
+    static constexpr size_t BIN_COUNT = 16;
+    static constexpr size_t MAX_LEAF_SIZE = 8; // leaves only split further when the SAH says so
+    // cost of testing a node, relative to testing a primitive
+    static constexpr float TRAVERSAL_COST = 1.0f;
+    // smaller ranges are built on one worker
+    static constexpr size_t MIN_PARALLEL_PRIMITIVES = 4096;
+    // deeper ranges become leaves whatever their size, bounds the query stacks
+    static constexpr size_t MAX_DEPTH = 64;
+
+    struct Node {
+        glm::vec3 min;
+        uint32_t first; // left child, the right one follows, or first primitive of a leaf
+        glm::vec3 max;
+        uint32_t count; // primitives, 0 for an inner node
+
+        bool isLeaf() const { return count != 0; }
+    };
+    static_assert(sizeof(Node) == 32, "two nodes per cache line");
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_primitives; // leaves index ranges of it
+    std::vector<Aabb> m_bounds;         // per primitive
+    std::vector<glm::vec3> m_centers;   // of m_bounds, while building
+
+public:
+    // -- Build --
+
+    // Replaces the tree, primitive i has bounds[i]
+    void build(std::vector<Aabb> bounds);
+    // Same, subtrees are built on the pool once the top levels split the
+    // primitives in enough ranges
+    void build(std::vector<Aabb> bounds, ThreadPool& pool);
+
+    // Updates the bounds of every primitive and the nodes above them, the
+    // topology stays, so queries slow down if primitives moved far.
+    // @throws std::runtime_error if the primitive count changed
+    void refit(const std::vector<Aabb>& bounds);
+
+    // -- Queries --
+
+    // Replaces `visible` with the primitives intersecting the frustum, in
+    // tree order. Subtrees fully inside are taken without testing their
+    // primitives
+    size_t cull(const Frustum& frustum, VisibleList& visible) const;
+
+    // Closest primitive hit by the ray within maxDistance, direction need not
+    // be normalized
+    std::optional<RayHit> raycast(glm::vec3 origin, glm::vec3 direction,
+                                  float maxDistance = std::numeric_limits<float>::max()) const;
+
+    // -- Getters --
+    size_t getPrimitiveCount() const { return m_bounds.size(); }
+    const std::vector<Node>& getNodes() const { return m_nodes; }
+
+private:
+    // -- Private methods --
+
+    struct Range {
+        uint32_t node;
+        uint32_t begin, end;
+        size_t depth;
+    };
+
+    // Takes the bounds and adds the root, @returns false without primitives
+    bool reset(std::vector<Aabb> bounds);
+    // Builds the subtree of nodes[range.node] over m_primitives[begin, end).
+    // With `deferred`, ranges of at most deferBelow primitives (but the root)
+    // are left as leaves listed there, to be built on their own
+    void buildNode(std::vector<Node>& nodes, Range range, size_t deferBelow, std::vector<Range>* deferred);
+    // Appends the subtree built in `nodes` (root first) at the place of m_nodes[node]
+    void graft(uint32_t node, const std::vector<Node>& nodes);
+    void refitNodes();
+};
@@ -4,11 +4,30 @@
 #include <glm/vec3.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include "Culling.hpp"
 #include "Movable.hpp"
+#include "Std140.hpp"
+
+// uniform Camera block shared by the shaders, laid out as std140
+struct CameraBlock {
+    alignas(16) glm::mat4 view;
+    alignas(16) glm::mat4 projection;
+    alignas(16) glm::vec3 viewPos;
+};
+
+STD140_CHECK_MEMBER(CameraBlock, view, 0);
+STD140_CHECK_MEMBER(CameraBlock, projection, 64);
+STD140_CHECK_MEMBER(CameraBlock, viewPos, 128);
+
 class Camera{
     virtual glm::mat4 getProjectionMat()const = 0;
     virtual glm::mat4 getViewMat()const = 0;
     virtual glm::mat4 getProjectionViewMat()const = 0;
+
+public:
+    // -- Culling --
+    // World space planes of the view volume, from getProjectionViewMat()
+    Frustum getFrustum()const;
 };
 
 
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "RenderQueue.hpp"
+#include "ThreadPool.hpp"
+#include "UniformBlock.hpp"
+
+class Program;
+class VertexArray;
+
+// -- Command list --
+
+// Rendering commands recorded without touching GL, so any thread can fill a
+// list, and replayed later by the GL thread. Commands and their payloads
+// (uniform block contents, buffer data) are packed one after the other in a
+// linear buffer that keeps its capacity across clear(), a list reused every
+// frame stops allocating once it reached its working size.
+// A list is recorded by one thread at a time, GL objects it references must
+// outlive its replay.
+class CommandList
+{
+public:
+    enum class CommandType : uint32_t {
+        USE_PROGRAM,
+        BIND_TEXTURE,
+        SET_UNIFORM_BLOCK,
+        UPLOAD_BUFFER,
+        DRAW,
+        SUBMIT,
+    };
+
+    // -- Commands --
+    struct CommandHeader {
+        CommandType type;
+        uint32_t size; // header, command and payload, aligned
+    };
+    struct UseProgramCommand {
+        Program* program;
+    };
+    struct BindTextureCommand {
+        GLuint unit;
+        GLenum target;
+        GLuint texture;
+    };
+    // followed by `size` bytes copied to the buffer bound at bindingPoint
+    struct SetUniformBlockCommand {
+        GLuint bindingPoint;
+        GLuint buffer;
+        size_t size;
+    };
+    // followed by `size` bytes copied at `offset` in the buffer
+    struct UploadBufferCommand {
+        GLuint buffer;
+        size_t offset;
+        size_t size;
+    };
+    struct DrawCommand {
+        const VertexArray* vertexArray;
+        GLsizei instanceCount; // 0 is a plain draw
+        GLenum mode;
+    };
+    // handed to the render queue given to replay()
+    struct SubmitCommand {
+        DrawSubmission submission;
+    };
+
+private:
+    static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+    // not a std::vector, resizing it would zero the payloads before they are written
+    std::unique_ptr<std::byte[]> m_data;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+    size_t m_commandCount = 0;
+
+public:
+    // -- Getters --
+    size_t getCommandCount() const { return m_commandCount; }
+    size_t getByteSize() const { return m_size; }
+
+    // -- Recording --
+
+    // Forgets every command, keeps the memory
+    void clear() {
+        m_size = 0;
+        m_commandCount = 0;
+    }
+
+    void useProgram(Program& program) { record(CommandType::USE_PROGRAM, UseProgramCommand{&program}); }
+
+    void bindTexture(GLuint unit, GLenum target, GLuint texture) {
+        record(CommandType::BIND_TEXTURE, BindTextureCommand{unit, target, texture});
+    }
+
+    // Copies data, see UniformBlock::getBufferId
+    void setUniformBlock(GLuint bindingPoint, GLuint buffer, const void* data, size_t size) {
+        void* payload = record(CommandType::SET_UNIFORM_BLOCK, SetUniformBlockCommand{bindingPoint, buffer, size}, size);
+        std::memcpy(payload, data, size);
+    }
+
+    template <typename T>
+    void setUniformBlock(const UniformBlock<T>& block, const T& data) {
+        setUniformBlock(block.getBindingPoint(), block.getBufferId(), &data, sizeof(T));
+    }
+
+    // @returns where to write the `size` bytes, valid until the next record
+    void* uploadBuffer(GLuint buffer, size_t offset, size_t size) {
+        return record(CommandType::UPLOAD_BUFFER, UploadBufferCommand{buffer, offset, size}, size);
+    }
+
+    void draw(const VertexArray& vertexArray, GLsizei instanceCount = 0, GLenum mode = GL_TRIANGLES) {
+        record(CommandType::DRAW, DrawCommand{&vertexArray, instanceCount, mode});
+    }
+
+    void submit(const DrawSubmission& submission) { record(CommandType::SUBMIT, SubmitCommand{submission}); }
+
+    // -- Replay --
+
+    // Issues the commands in recording order, SUBMIT ones go to `queue`.
+    // GL thread only
+    void replay(RenderQueue& queue) const;
+
+private:
+    static constexpr size_t align(size_t size) { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    // @returns the payload of the new command
+    template <typename C>
+    void* record(CommandType type, const C& command, size_t payloadSize = 0) {
+        static_assert(std::is_trivially_copyable_v<C>, "commands are replayed from raw bytes");
+        constexpr size_t COMMAND_OFFSET = align(sizeof(CommandHeader));
+        constexpr size_t PAYLOAD_OFFSET = COMMAND_OFFSET + align(sizeof(C));
+        const size_t size = PAYLOAD_OFFSET + align(payloadSize);
+
+        if (m_size + size > m_capacity)
+            grow(m_size + size);
+        std::byte* bytes = m_data.get() + m_size;
+        m_size += size;
+        new (bytes) CommandHeader{type, static_cast<uint32_t>(size)};
+        new (bytes + COMMAND_OFFSET) C(command);
+        m_commandCount++;
+        return bytes + PAYLOAD_OFFSET;
+    }
+
+    // Doubles the capacity until it holds `size` bytes, commands are trivially
+    // copyable so they move with memcpy
+    void grow(size_t size) {
+        size_t capacity = m_capacity < 4096 ? 4096 : m_capacity;
+        while (capacity < size)
+            capacity *= 2;
+
+        std::unique_ptr<std::byte[]> data(new std::byte[capacity]);
+        if (m_size != 0)
+            std::memcpy(data.get(), m_data.get(), m_size);
+        m_data = std::move(data);
+        m_capacity = capacity;
+    }
+};
+
+// -- Parallel recording --
+
+// Splits [0, count) in lists.size() contiguous ranges and calls
+// record(list, begin, end) for each on the pool, one list per range, then
+// waits for all of them. Exceptions of a range are rethrown here.
+// The lists are cleared first and replaying them in order keeps [0, count)
+// in order.
+template <typename F>
+void recordParallel(ThreadPool& pool, std::vector<CommandList>& lists, size_t count, F&& record) {
+    std::vector<std::future<void>> recorded;
+    recorded.reserve(lists.size());
+
+    const size_t rangeCount = lists.size();
+    for (size_t i = 0; i < rangeCount; i++) {
+        CommandList& list = lists[i];
+        list.clear();
+        size_t begin = count * i / rangeCount;
+        size_t end = count * (i + 1) / rangeCount;
+        if (begin == end)
+            continue;
+        recorded.push_back(pool.submit([&record, &list, begin, end]() { record(list, begin, end); }));
+    }
+    // every range must be done before one rethrows, they reference `record`
+    for (std::future<void>& range : recorded)
+        range.wait();
+    for (std::future<void>& range : recorded)
+        range.get();
+}
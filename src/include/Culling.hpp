@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// -- SIMD path --
+
+// Chosen at build time from the target instruction set (see NATIVE_ARCH in
+// CMakeLists.txt) : 8 lanes with AVX, 4 with SSE2, else scalar
+#if defined(__AVX__)
+#define CULLING_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULLING_SSE 1
+#endif
+
+// -- Frustum --
+
+// Six planes (a, b, c, d) with (a, b, c) normalized and pointing inside, a
+// point p is inside a plane when dot((a, b, c), p) + d >= 0
+struct Frustum {
+    enum Plane : size_t {
+        PLANE_LEFT,
+        PLANE_RIGHT,
+        PLANE_BOTTOM,
+        PLANE_TOP,
+        PLANE_NEAR,
+        PLANE_FAR,
+        PLANE_COUNT,
+    };
+
+    glm::vec4 planes[PLANE_COUNT];
+
+    // Gribb-Hartmann extraction, planes come out in the space the matrix
+    // transforms from : world space for projection * view
+    static Frustum fromMatrix(const glm::mat4& projectionView);
+
+    // Conservative, a volume straddling two planes outside the frustum near
+    // one of its corners is kept
+    bool intersectsSphere(glm::vec3 center, float radius) const;
+    bool intersectsAabb(glm::vec3 min, glm::vec3 max) const;
+};
+
+// -- Bounding volumes --
+
+// Spheres stored as structure of arrays, the culling loads one member of
+// several spheres at a time
+class BoundingSpheres
+{
+private:
+    std::vector<float> m_x, m_y, m_z, m_radius;
+
+public:
+    // -- Methods --
+    void push(glm::vec3 center, float radius);
+    void set(size_t index, glm::vec3 center, float radius);
+    void reserve(size_t count);
+    void clear();
+
+    // -- Getters --
+    size_t size() const { return m_x.size(); }
+    const float* getX() const { return m_x.data(); }
+    const float* getY() const { return m_y.data(); }
+    const float* getZ() const { return m_z.data(); }
+    const float* getRadius() const { return m_radius.data(); }
+};
+
+// Axis aligned boxes stored as structure of arrays of centers and half
+// extents, which turns the box test into a sphere test with a per plane radius
+class BoundingBoxes
+{
+private:
+    std::vector<float> m_x, m_y, m_z;
+    std::vector<float> m_extentX, m_extentY, m_extentZ;
+
+public:
+    // -- Methods --
+    void push(glm::vec3 min, glm::vec3 max);
+    void set(size_t index, glm::vec3 min, glm::vec3 max);
+    void reserve(size_t count);
+    void clear();
+
+    // -- Getters --
+    size_t size() const { return m_x.size(); }
+    const float* getX() const { return m_x.data(); }
+    const float* getY() const { return m_y.data(); }
+    const float* getZ() const { return m_z.data(); }
+    const float* getExtentX() const { return m_extentX.data(); }
+    const float* getExtentY() const { return m_extentY.data(); }
+    const float* getExtentZ() const { return m_extentZ.data(); }
+};
+
+// -- Culling --
+
+// Indices written by the culling. Not a std::vector, growing it back every
+// frame would zero the storage before the culling overwrites it
+class VisibleList
+{
+private:
+    std::unique_ptr<uint32_t[]> m_indices;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+
+public:
+    // -- Getters --
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const uint32_t* data() const { return m_indices.get(); }
+    const uint32_t* begin() const { return m_indices.get(); }
+    const uint32_t* end() const { return m_indices.get() + m_size; }
+    uint32_t operator[](size_t i) const { return m_indices[i]; }
+
+    // -- Methods --
+
+    // Empties the list, @returns room for `capacity` indices, kept until the
+    // next prepare
+    uint32_t* prepare(size_t capacity);
+    void setSize(size_t size) { m_size = size; }
+};
+
+// Replaces `visible` with the increasing indices of the volumes intersecting
+// the frustum, with the widest SIMD path of the build.
+// @returns the number of visible volumes
+size_t cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, VisibleList& visible);
+size_t cullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, VisibleList& visible);
+
+// Same, one volume at a time, the reference of the SIMD paths
+size_t cullSpheresScalar(const Frustum& frustum, const BoundingSpheres& spheres, VisibleList& visible);
+size_t cullBoxesScalar(const Frustum& frustum, const BoundingBoxes& boxes, VisibleList& visible);
+
+// "AVX", "SSE" or "scalar"
+const char* cullingPath();
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+// DirectDraw Surface container, limited to what TextureCompressor writes:
+// 2D textures in DXT1 (BC1), DXT3 (BC2) or DXT5 (BC3) with their mip chain.
+// The rows are stored bottom up, ready for glCompressedTexImage2D.
+
+struct DdsLevel {
+    const unsigned char* data;
+    GLsizei size; // bytes
+    GLsizei width;
+    GLsizei height;
+};
+
+// Maps a .dds file, the levels point into the mapping and stay valid as long
+// as the DdsFile lives
+class DdsFile
+{
+private:
+    MappedFile m_file;
+    GLenum m_internalFormat;
+    std::vector<DdsLevel> m_levels;
+
+public:
+    // -- Constructors --
+    explicit DdsFile(const char* path);
+
+    // -- Getters --
+    GLenum getInternalFormat() const { return m_internalFormat; }
+    GLsizei getWidth() const { return m_levels.front().width; }
+    GLsizei getHeight() const { return m_levels.front().height; }
+    const std::vector<DdsLevel>& getLevels() const { return m_levels; }
+};
+
+// Writes the compressed `levels`, level 0 being width x height and each next
+// one half the size of the previous
+void writeDds(const char* path, GLenum internalFormat, GLsizei width, GLsizei height,
+              const std::vector<std::vector<unsigned char>>& levels);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string_view>
+#include <vector>
+
+// Offscreen render target: an RGBA8 color and a 24 bit depth renderbuffer.
+// Used by the headless mode, the default framebuffer of an invisible window
+// is not guaranteed to be rendered to.
+class Framebuffer
+{
+private:
+    GLuint m_glId;
+    GLuint m_colorId;
+    GLuint m_depthId;
+    GLsizei m_width;
+    GLsizei m_height;
+
+public:
+    // -- Constructors --
+    // @throws std::runtime_error if the framebuffer is incomplete
+    Framebuffer(GLsizei width, GLsizei height);
+
+    Framebuffer(Framebuffer&& other) noexcept;
+    Framebuffer& operator=(Framebuffer&& other) noexcept;
+
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+
+    // -- Destructor --
+    ~Framebuffer();
+
+    // -- Getters --
+    GLuint getGlId() const { return m_glId; }
+    GLsizei getWidth() const { return m_width; }
+    GLsizei getHeight() const { return m_height; }
+
+    // -- Methods --
+    // Binds for drawing and reading and sets the viewport to the whole target
+    void bind() const;
+    // Back to the default framebuffer, the viewport is left as is
+    void unbind() const;
+
+    // RGBA8 rows, bottom up like GL returns them
+    void readPixels(std::vector<unsigned char>& pixels) const;
+    // Writes the color buffer top down as a PNG
+    // @throws std::runtime_error if the file cannot be written
+    void writePng(const char* path) const;
+
+    void setLabel(std::string_view label) const;
+
+private:
+    void release();
+};
@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 #include <cstddef>
+#include <string_view>
 
 
 template <typename T, const GLenum BufferType>
@@ -9,6 +10,7 @@ class GlBuffer
 {
 protected:
     GLuint m_glId;
+    size_t m_count;
 
 public:
     //-- Constructors --
@@ -28,11 +30,22 @@ public:
 
     //-- Methods --
     void uploadData(const T* data,size_t count, GLenum usage);
+    void uploadSubData(const T* data,size_t count, size_t offset);
+
+    // Maps `count` T from `offset` (in T) with glMapBufferRange, the pointer
+    // can be written from any thread but GL must not use the buffer until unmap
+    T* mapRange(size_t offset,size_t count, GLbitfield access);
+    void unmap();
 
     void bind() const;
     void unbind() const;
+    void bindBase(GLuint bindingPoint) const;
+
+    void setLabel(std::string_view label) const;
 
     inline GLuint getGlId() const{return m_glId;}
+    // number of T held by the buffer since the last uploadData
+    inline size_t getCount() const{return m_count;}
 };
 
 // -- Alias --
@@ -42,3 +55,9 @@ using IndexBuffer = GlBuffer<I,GL_ELEMENT_ARRAY_BUFFER>;
 
 template <typename V>
 using VertexBuffer = GlBuffer<V,GL_ARRAY_BUFFER>;
+
+template <typename U>
+using UniformBuffer = GlBuffer<U,GL_UNIFORM_BUFFER>;
+
+template <typename P>
+using PixelUnpackBuffer = GlBuffer<P,GL_PIXEL_UNPACK_BUFFER>;
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string_view>
+
+// -- KHR_debug enums --
+
+// glad is generated for the 3.3 core profile only, GL_KHR_debug (core since
+// 4.3) is exposed by most 3.3 drivers but its enums and entry points are missing
+#ifndef GL_DEBUG_OUTPUT
+#define GL_DEBUG_OUTPUT                  0x92E0
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS      0x8242
+#define GL_CONTEXT_FLAG_DEBUG_BIT        0x00000002
+
+#define GL_DEBUG_SOURCE_API              0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM    0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER  0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY      0x8249
+#define GL_DEBUG_SOURCE_APPLICATION      0x824A
+#define GL_DEBUG_SOURCE_OTHER            0x824B
+
+#define GL_DEBUG_TYPE_ERROR              0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR 0x824E
+#define GL_DEBUG_TYPE_PORTABILITY        0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE        0x8250
+#define GL_DEBUG_TYPE_OTHER              0x8251
+#define GL_DEBUG_TYPE_MARKER             0x8268
+#define GL_DEBUG_TYPE_PUSH_GROUP         0x8269
+#define GL_DEBUG_TYPE_POP_GROUP          0x826A
+
+#define GL_DEBUG_SEVERITY_HIGH           0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM         0x9147
+#define GL_DEBUG_SEVERITY_LOW            0x9148
+#define GL_DEBUG_SEVERITY_NOTIFICATION   0x826B
+
+// glObjectLabel identifiers, GL_TEXTURE already is a core enum
+#define GL_BUFFER                        0x82E0
+#define GL_PROGRAM                       0x82E2
+#define GL_VERTEX_ARRAY                  0x8074
+#define GL_MAX_LABEL_LENGTH              0x82E8
+#endif
+
+// -- Debug output --
+
+// GL_KHR_debug messages of the (single) GL context. The callback only copies
+// a message into a lock-free ring, a logging thread prints it to std::cerr,
+// so the driver thread or the render thread never wait on the console.
+// Messages arriving while the ring is full are dropped and counted.
+// Without checks the output is asynchronous, with them it is synchronous and
+// a message shows up inside the faulty call (break in the callback).
+class GlDebugOutput
+{
+public:
+    // longer messages are truncated
+    static constexpr size_t MAX_MESSAGE_LENGTH = 480;
+    static constexpr size_t RING_CAPACITY = 256;
+
+    // -- Init --
+
+    // @returns true if the current context exposes GL_KHR_debug (or is 4.3+)
+    static bool isSupported();
+
+    // Loads the KHR_debug entry points with `load`, the loader glad was
+    // initialized with (glfwGetProcAddress), registers the callback and starts
+    // the logging thread. Messages below minSeverity are disabled.
+    // @returns false if the context does not expose GL_KHR_debug
+    static bool init(GLADloadproc load, GLenum minSeverity = GL_DEBUG_SEVERITY_LOW);
+
+    // Disables the output and joins the logging thread once every queued
+    // message is printed, the context must still be current.
+    // Skipped, the thread is still joined at exit but the output stays enabled
+    static void shutdown();
+
+    // -- Getters --
+    static bool isActive();
+    // messages lost because the ring was full
+    static size_t getDroppedCount();
+
+    // -- Methods --
+
+    // Enables every severity from minSeverity up to GL_DEBUG_SEVERITY_HIGH
+    // (NOTIFICATION < LOW < MEDIUM < HIGH) and disables the others
+    static void setMinSeverity(GLenum minSeverity);
+
+    // Names the object in the messages (and in GPU debuggers), no-op without
+    // KHR_debug. identifier is GL_BUFFER, GL_PROGRAM, GL_VERTEX_ARRAY,
+    // GL_TEXTURE or GL_FRAMEBUFFER, the object must have been bound once
+    static void label(GLenum identifier, GLuint name, std::string_view text);
+};
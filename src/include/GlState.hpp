@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// -- Stats --
+
+struct GlCallCounter {
+    size_t issued = 0;
+    size_t elided = 0; // skipped, GL already was in that state
+};
+
+struct GlStateStats {
+    GlCallCounter textures;
+    GlCallCounter programs;
+    GlCallCounter vertexArrays;
+    GlCallCounter buffers;
+    GlCallCounter capabilities;
+};
+
+// -- State cache --
+
+// Shadow copy of the bindings of the (single) GL context, the bind calls
+// below only reach GL when the value actually changes.
+// Everything that binds textures, programs, VAOs, buffers or toggles depth /
+// blend state must go through it, otherwise call invalidate() afterwards.
+class GlState
+{
+public:
+    static constexpr GLuint MAX_TEXTURE_UNITS = 32;
+
+    // -- Bindings --
+    static void activeTexture(GLuint unit);
+    // binds to the active unit
+    static void bindTexture(GLenum target, GLuint texture);
+    static void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    static void useProgram(GLuint program);
+
+    // Also forgets the element array buffer, it is part of the VAO state
+    static void bindVertexArray(GLuint vertexArray);
+
+    static void bindBuffer(GLenum target, GLuint buffer);
+    // Binds both the indexed and the generic binding point, like GL does
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+    // -- Fixed function state --
+    // GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_STENCIL_TEST and
+    // GL_SCISSOR_TEST are cached, other capabilities go straight to GL
+    static void setEnabled(GLenum capability, bool enabled);
+    static void depthFunc(GLenum func);
+    static void depthMask(GLboolean write);
+    static void blendFunc(GLenum source, GLenum destination);
+
+    // -- Deletion --
+    // GL drops the bindings of a deleted object and may reuse its name, call
+    // these right after the glDelete*
+    static void forgetTexture(GLuint texture);
+    static void forgetProgram(GLuint program);
+    static void forgetVertexArray(GLuint vertexArray);
+    static void forgetBuffer(GLuint buffer);
+
+    // Marks every cached value unknown, the next calls will reach GL
+    static void invalidate();
+
+    // -- Stats --
+    static const GlStateStats& getStats();
+    static void resetStats();
+};
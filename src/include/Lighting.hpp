@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Std140.hpp"
+
+// C++ side of the lights declared in cube.frag, laid out as std140.
+// Keep the members in the same order as the GLSL structs.
+
+// must match NR_POINT_LIGHTS in cube.frag
+constexpr int NR_POINT_LIGHTS = 4;
+
+struct DirLight {
+    alignas(16) glm::vec3 direction;
+
+    alignas(16) glm::vec3 ambient;
+    alignas(16) glm::vec3 diffuse;
+    alignas(16) glm::vec3 specular;
+};
+
+struct PointLight {
+    alignas(16) glm::vec3 position;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    alignas(16) glm::vec3 ambient;
+    alignas(16) glm::vec3 diffuse;
+    alignas(16) glm::vec3 specular;
+};
+
+struct SpotLight {
+    alignas(16) glm::vec3 position;
+    alignas(16) glm::vec3 direction;
+    float cutOff;
+    float outerCutOff;
+
+    alignas(16) glm::vec3 ambient;
+    alignas(16) glm::vec3 diffuse;
+    alignas(16) glm::vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+// uniform Lights block
+struct LightingBlock {
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+};
+
+// -- Layout checks --
+
+STD140_CHECK_MEMBER(DirLight, direction, 0);
+STD140_CHECK_MEMBER(DirLight, ambient, 16);
+STD140_CHECK_MEMBER(DirLight, diffuse, 32);
+STD140_CHECK_MEMBER(DirLight, specular, 48);
+
+STD140_CHECK_MEMBER(PointLight, position, 0);
+STD140_CHECK_MEMBER(PointLight, constant, 12);
+STD140_CHECK_MEMBER(PointLight, linear, 16);
+STD140_CHECK_MEMBER(PointLight, quadratic, 20);
+STD140_CHECK_MEMBER(PointLight, ambient, 32);
+STD140_CHECK_MEMBER(PointLight, diffuse, 48);
+STD140_CHECK_MEMBER(PointLight, specular, 64);
+
+STD140_CHECK_MEMBER(SpotLight, position, 0);
+STD140_CHECK_MEMBER(SpotLight, direction, 16);
+STD140_CHECK_MEMBER(SpotLight, cutOff, 28);
+STD140_CHECK_MEMBER(SpotLight, outerCutOff, 32);
+STD140_CHECK_MEMBER(SpotLight, ambient, 48);
+STD140_CHECK_MEMBER(SpotLight, diffuse, 64);
+STD140_CHECK_MEMBER(SpotLight, specular, 80);
+STD140_CHECK_MEMBER(SpotLight, constant, 92);
+STD140_CHECK_MEMBER(SpotLight, linear, 96);
+STD140_CHECK_MEMBER(SpotLight, quadratic, 100);
+
+STD140_CHECK_MEMBER(LightingBlock, dirLight, 0);
+STD140_CHECK_MEMBER(LightingBlock, pointLights, 64);
+STD140_CHECK_MEMBER(LightingBlock, spotLight, 384);
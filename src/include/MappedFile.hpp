@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+// Read only memory mapping of a whole file, the pages are loaded by the OS on
+// first access instead of being copied into a buffer
+class MappedFile
+{
+private:
+    const char* m_data;
+    size_t m_size;
+
+public:
+    // -- Constructors --
+    explicit MappedFile(const char* path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // -- Destructor --
+    ~MappedFile();
+
+    // -- Getters --
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+
+private:
+    void unmap();
+};
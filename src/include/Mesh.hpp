@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Interleaved float vertices with their indices, laid out as the VertexLayout
+// they are uploaded with
+struct MeshData {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    size_t stride; // floats per vertex
+};
+
+// Merges bitwise identical vertices (position, normal, uv...) of a non indexed
+// vertex list, triangles are kept in the same order
+MeshData weldVertices(const float* vertices, size_t vertexCount, size_t stride);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MappedFile.hpp"
+#include "Mesh.hpp"
+#include "VertexLayout.hpp"
+
+// Baked mesh format (.mesh), written offline by the MeshBaker tool and mapped
+// as is at run time:
+//   MeshFileHeader | vertex blob | index blob
+// Both blobs start on a MESH_FILE_ALIGNMENT boundary, the vertices are
+// interleaved as described by the header attributes and the indices are
+// already narrowed to `indexType`.
+
+constexpr char MESH_FILE_MAGIC[4] = {'M', 'E', 'S', 'H'};
+constexpr uint32_t MESH_FILE_VERSION = 1;
+constexpr uint32_t MESH_FILE_MAX_ATTRIBUTES = 8;
+constexpr size_t MESH_FILE_ALIGNMENT = 16;
+
+struct MeshFileAttribute {
+    uint32_t glType;
+    uint32_t count;
+    uint32_t normalized;
+};
+
+struct MeshFileHeader {
+    char magic[4];
+    uint32_t version;
+
+    uint32_t attributeCount;
+    MeshFileAttribute attributes[MESH_FILE_MAX_ATTRIBUTES];
+    uint32_t stride; // bytes per vertex
+
+    uint32_t vertexCount;
+    uint32_t indexType; // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    uint32_t indexCount;
+    uint32_t reserved = 0; // keeps the offsets 8 byte aligned, the header holds no implicit padding
+
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+};
+static_assert(sizeof(MeshFileHeader) == 144, "the header is written and mapped as raw bytes");
+
+// Read only view of a baked mesh, the pointers refer to the mapping and stay
+// valid as long as the MeshFile lives
+class MeshFile
+{
+private:
+    MappedFile m_file;
+    const MeshFileHeader* m_header;
+
+public:
+    // -- Constructors --
+    explicit MeshFile(const char* path);
+
+    // -- Getters --
+    VertexLayout getLayout() const;
+
+    const std::byte* getVertices() const;
+    size_t getVertexCount() const { return m_header->vertexCount; }
+    size_t getVerticesSize() const { return size_t(m_header->vertexCount) * m_header->stride; }
+
+    const void* getIndices() const;
+    GLenum getIndexType() const { return m_header->indexType; }
+    size_t getIndexCount() const { return m_header->indexCount; }
+};
+
+// Writes `mesh` with the given vertex layout, the indices are stored with the
+// smallest type that holds them
+void writeMeshFile(const char* path, const MeshData& mesh, const VertexLayout& layout);
@@ -4,6 +4,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <cstdint>
+
 class Movable
 {
 public :
@@ -23,14 +25,25 @@ public :
 
     virtual glm::mat4 getTransforms() const = 0;
     virtual glm::mat4 getTransformsInverse() const = 0;
+    virtual glm::mat3 getNormalMatrix() const = 0;
 };
 
+// Position, size and rotation, with the matrices built on the first read
+// after a change and cached until the next one. The overrides are final so
+// calls through a Transform skip the virtual dispatch.
+// Reading the matrices fills the cache, a Transform read from several
+// threads at once must have been read once before.
 class Transform : public Movable
 {
 protected :
     glm::vec3 m_position, m_size;
     glm::quat m_rotation;
 
+private :
+    mutable glm::mat4 m_transforms, m_transformsInverse;
+    mutable bool m_transformsDirty, m_inverseDirty;
+    uint64_t m_version;
+
 public :
     // -- Constructors --
     Transform();
@@ -38,19 +51,39 @@ public :
     Transform(float position[3], float size[3], float rotation[4]);
 
 
-    void setPos(glm::vec3 pos) override;
-    void setSize(glm::vec3 size) override;
-    void setRotation(glm::quat rotation) override;
+    void setPos(glm::vec3 pos) final;
+    void setSize(glm::vec3 size) final;
+    void setRotation(glm::quat rotation) final;
 
-    glm::vec3 getPos() const override;
-    glm::vec3 getSize() const override;
-    glm::quat getRotation() const override;
+    glm::vec3 getPos() const final;
+    glm::vec3 getSize() const final;
+    glm::quat getRotation() const final;
     
-    void translate(glm::vec3 trans) override;
-    void scale(glm::vec3 scale) override;
-    void rotate(glm::quat rotation) override;
+    void translate(glm::vec3 trans) final;
+    void scale(glm::vec3 scale) final;
+    void rotate(glm::quat rotation) final;
+
+    glm::mat4 getTransforms() const final;
+    glm::mat4 getTransformsInverse() const final;
+    glm::mat3 getNormalMatrix() const final;
+
+    // Incremented by every change, a cache built from the matrices is still
+    // valid while the version it saw is
+    uint64_t getVersion() const {return m_version;}
 
-    glm::mat4 getTransforms() const override;
-    glm::mat4 getTransformsInverse() const override;
+protected :
+    // To call after changing the members directly
+    void markDirty();
+};
+
+// Per instance vertex data, the normal matrix is computed once per object
+// instead of once per vertex in the shader
+struct InstanceTransform
+{
+    glm::mat4 model;
+    glm::mat3 normal;
 
+    InstanceTransform() = default;
+    explicit InstanceTransform(const Movable& movable)
+        : model(movable.getTransforms()), normal(movable.getNormalMatrix()) {}
 };
\ No newline at end of file
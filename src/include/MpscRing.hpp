@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free queue, any number of producers and a single consumer.
+// Each cell carries a sequence number telling whose turn it is: a producer
+// claims a cell by bumping the head, fills it, then publishes it by storing
+// pos + 1 in its sequence; the consumer hands it back with pos + Capacity.
+// Producers never block nor allocate, a push on a full ring fails.
+template <typename T, size_t Capacity>
+class MpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+    // keeps the producers' and the consumer's counters on their own cache line
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    alignas(CACHE_LINE) std::atomic<size_t> m_head;
+    alignas(CACHE_LINE) size_t m_tail;
+    alignas(CACHE_LINE) Cell m_cells[Capacity];
+
+public:
+    // -- Constructors --
+    MpscRing() : m_head(0), m_tail(0) {
+        for (size_t i = 0; i < Capacity; i++)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // -- Methods --
+
+    // Safe from any thread
+    // @returns false if the ring is full, value is then dropped
+    bool tryPush(const T& value) {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & MASK];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                // the cell is free for this lap, try to claim it
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                // the consumer has not released the cell from the previous lap
+                return false;
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only from the consumer thread
+    // @returns false if no value is published yet
+    bool tryPop(T& value) {
+        Cell& cell = m_cells[m_tail & MASK];
+        if (cell.sequence.load(std::memory_order_acquire) != m_tail + 1)
+            return false;
+
+        value = cell.value;
+        cell.sequence.store(m_tail + Capacity, std::memory_order_release);
+        m_tail++;
+        return true;
+    }
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Mesh.hpp"
+
+// Wavefront OBJ loading, only v/vt/vn/f lines are read (objects, groups and
+// materials are ignored) and polygons are triangulated as fans.
+// The mesh is welded and laid out as position(3) normal(3) uv(2), missing
+// normals or uvs are left to zero.
+constexpr size_t OBJ_VERTEX_STRIDE = 8;
+
+// Maps the file and parses it in a single pass
+MeshData loadObj(const char* path);
+
+// Parses OBJ text held in [begin, end)
+MeshData parseObj(const char* begin, const char* end);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "GlBuffer.hpp"
+#include "Texture.hpp"
+#include "TextureArray.hpp"
+
+// Ring of pixel unpack buffers used to stream texture uploads.
+// A slot is mapped on the GL thread, filled from any thread, then unmapped and
+// copied into a texture layer by the GPU. A fence tells when the slot can be reused,
+// so the GL thread never waits on a transfer.
+// GL 3.3 has no persistent mapping, slots are mapped with glMapBufferRange on
+// each acquire.
+class PixelUploadRing
+{
+private:
+    struct Slot {
+        PixelUnpackBuffer<GLubyte> buffer;
+        size_t capacity;
+        GLsync fence; // set while the GPU may still read the slot
+        GLubyte* mapped;
+    };
+
+    std::vector<Slot> m_slots;
+
+public:
+    // -- Constructors --
+    explicit PixelUploadRing(size_t slotCount = 3);
+
+    PixelUploadRing(const PixelUploadRing&) = delete;
+    PixelUploadRing& operator=(const PixelUploadRing&) = delete;
+
+    // -- Destructor --
+    ~PixelUploadRing();
+
+    // -- Methods --
+    // All of them are GL thread only.
+
+    // Maps a free slot of at least `size` bytes without blocking.
+    // @returns the slot index, -1 when every slot is in flight
+    int acquire(size_t size);
+
+    // Pointer to the mapping of an acquired slot, valid until upload()
+    GLubyte* getMapped(int slot) const { return m_slots[slot].mapped; }
+
+    // Unmaps the slot and copies its first width * height pixels into `texture`
+    void upload(int slot, Texture& texture, GLsizei width, GLsizei height);
+
+    // Unmaps the slot and copies the padded layer it holds, an image of
+    // imageWidth x imageHeight, into `layer` of `array`
+    void upload(int slot, TextureArray& array, GLint layer, GLsizei imageWidth, GLsizei imageHeight);
+
+private:
+    bool isInFlight(Slot& slot);
+    void unmap(Slot& slot);
+    // Unbinds the slot and fences the copies reading it
+    void release(Slot& slot);
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// -- Stats --
+
+// Percentiles of a series, in milliseconds
+struct ProfileStats {
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    size_t sampleCount = 0;
+};
+
+// The last `capacity` samples of a series, older ones are overwritten
+class SampleHistory
+{
+private:
+    std::vector<double> m_samples;
+    size_t m_next;
+
+public:
+    // -- Constructors --
+    explicit SampleHistory(size_t capacity);
+
+    // -- Methods --
+    void add(double sample);
+    // Nearest rank percentiles, sorts a copy of the window
+    ProfileStats computeStats() const;
+};
+
+// -- Profiler --
+
+// Frame time, CPU scopes and GPU passes of the render loop.
+// - CPU scopes can be recorded from any thread.
+// - GPU passes are GL_TIME_ELAPSED queries, so only one can be open at a
+//   time and they must be issued from the GL thread. Each frame owns a set of
+//   queries reused framesInFlight frames later, when its results are read
+//   back. A result still not available by then is dropped rather than waited
+//   for, the profiler never stalls the pipeline.
+// Every scope also lands in a trace, exported as Chrome trace JSON
+// (chrome://tracing or ui.perfetto.dev). GPU passes appear on their own track
+// at the time they were submitted, with their GPU duration.
+class Profiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t HISTORY_SIZE = 512;
+    static constexpr size_t MAX_GPU_PASSES = 16;      // per frame
+    static constexpr size_t MAX_TRACE_EVENTS = 1 << 18; // later events are not traced
+
+private:
+    struct TraceEvent {
+        const char* name;
+        Clock::time_point start;
+        Clock::duration duration;
+        uint32_t track; // 0 is the GPU, then one per CPU thread
+    };
+
+    struct GpuPass {
+        const char* name;
+        GLuint query;
+        Clock::time_point submitted;
+    };
+
+    struct FrameQueries {
+        std::vector<GpuPass> passes; // MAX_GPU_PASSES, queries created once
+        size_t used;
+    };
+
+    Clock::time_point m_origin;
+    Clock::time_point m_frameStart;
+    bool m_inFrame;
+
+    SampleHistory m_frameTimes;
+    std::unordered_map<std::string, SampleHistory> m_gpuTimes;
+
+    std::vector<FrameQueries> m_frames;
+    size_t m_frameIndex;
+    bool m_gpuPassOpen;
+    size_t m_droppedGpuResults;
+
+    // guards the members below, CPU scopes may end on any thread
+    mutable std::mutex m_traceMutex;
+    std::vector<TraceEvent> m_trace;
+    std::unordered_map<std::thread::id, uint32_t> m_tracks;
+
+public:
+    // -- Constructors --
+    // Needs a current GL context, creates framesInFlight * MAX_GPU_PASSES queries
+    explicit Profiler(size_t framesInFlight = 4);
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // -- Destructor --
+    ~Profiler();
+
+    // -- Frames --
+
+    // Reads back the GPU passes of the frame issued framesInFlight ago
+    void beginFrame();
+    void endFrame();
+
+    // -- Scopes --
+    void recordCpu(const char* name, Clock::time_point start, Clock::time_point end);
+
+    // `name` must outlive the profiler (a literal), passes cannot nest
+    // @throws std::runtime_error if a pass is already open
+    void beginGpu(const char* name);
+    void endGpu();
+
+    // -- Getters --
+    ProfileStats getFrameStats() const;
+    // Empty stats for a pass never resolved
+    ProfileStats getGpuStats(const std::string& name) const;
+    size_t getDroppedGpuResults() const { return m_droppedGpuResults; }
+
+    // -- Export --
+    void printStats(std::ostream& stream) const;
+    // @throws std::runtime_error if the file cannot be written
+    void writeChromeTrace(const char* path) const;
+
+private:
+    // -- Private methods --
+    void resolve(FrameQueries& frame);
+    void trace(const char* name, Clock::time_point start, Clock::duration duration, uint32_t track);
+};
+
+// -- Scopes --
+
+// Times its own lifetime on the CPU
+class CpuScope
+{
+private:
+    Profiler& m_profiler;
+    const char* m_name;
+    Profiler::Clock::time_point m_start;
+
+public:
+    CpuScope(Profiler& profiler, const char* name)
+        : m_profiler(profiler), m_name(name), m_start(Profiler::Clock::now()) {}
+    ~CpuScope() { m_profiler.recordCpu(m_name, m_start, Profiler::Clock::now()); }
+
+    CpuScope(const CpuScope&) = delete;
+    CpuScope& operator=(const CpuScope&) = delete;
+};
+
+// Times the GL commands issued during its lifetime on the GPU
+class GpuScope
+{
+private:
+    Profiler& m_profiler;
+
+public:
+    GpuScope(Profiler& profiler, const char* name) : m_profiler(profiler) { m_profiler.beginGpu(name); }
+    ~GpuScope() { m_profiler.endGpu(); }
+
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+};
@@ -6,27 +6,80 @@
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
 
 #include "Shader.hpp"
 #include "Texture.hpp"
+#include "TextureArray.hpp"
+
+// -- Uniform types --
+
+// Component type and count of the C++ types that can back a uniform
+template<typename T> struct UniformTraits;
+
+template<> struct UniformTraits<bool> 			{ using Component = bool; 			static constexpr GLenum glType = GL_BOOL; 			static constexpr size_t count = 1; };
+template<> struct UniformTraits<int> 			{ using Component = int; 			static constexpr GLenum glType = GL_INT; 			static constexpr size_t count = 1; };
+template<> struct UniformTraits<unsigned int> 	{ using Component = unsigned int; 	static constexpr GLenum glType = GL_UNSIGNED_INT; 	static constexpr size_t count = 1; };
+template<> struct UniformTraits<float> 			{ using Component = float; 			static constexpr GLenum glType = GL_FLOAT; 			static constexpr size_t count = 1; };
+
+template<glm::length_t L, typename T, glm::qualifier Q> struct UniformTraits<glm::vec<L,T,Q>> 	{ using Component = T; static constexpr GLenum glType = UniformTraits<T>::glType; static constexpr size_t count = L; };
+template<glm::length_t C, glm::length_t R, glm::qualifier Q> struct UniformTraits<glm::mat<C,R,float,Q>> 	{ using Component = float; static constexpr GLenum glType = GL_FLOAT; static constexpr size_t count = C * R; };
+
+// Typed index of an active uniform, resolved once with Program::getUniformHandle
+// A default constructed handle is invalid and setting it is a no-op
+template<typename T>
+class UniformHandle
+{
+	friend class Program;
+
+	static constexpr size_t INVALID_INDEX = SIZE_MAX;
+	size_t m_index;
+
+	explicit UniformHandle(size_t index) : m_index(index) {}
+
+public:
+	UniformHandle() : m_index(INVALID_INDEX) {}
+
+	bool isValid() const {return m_index != INVALID_INDEX;}
+};
+
+// Uniform uploads of a Program since the last reset
+struct UniformUploadStats
+{
+	size_t sent = 0;
+	size_t skipped = 0;
+};
 
 class Program
 {
+	// One slot of the uniform arena, sized from the linked program
 	struct UniformData
 	{
-
 		GLenum glType;
-		GLuint glLocation;
+		GLint glLocation;
 		size_t count;
-		std::byte* data;
-
-		// ~UniformData(){delete data;}
+		size_t offset;
+		bool dirty;
+	};
 
+	// Lets the indices be searched with a const char* without building a std::string
+	struct UniformNameHash
+	{
+		using is_transparent = void;
+		size_t operator()(std::string_view name) const {return std::hash<std::string_view>{}(name);}
 	};
-	struct TextureData
+
+	// One per sampler uniform, its texture unit is fixed at link time
+	struct SamplerBinding
 	{
-		std::string name;
-		GLuint glId;
+		GLint glLocation;
+		GLenum target;
+		GLuint unit;
+		GLuint textureId; // 0 until a texture is set
 	};
 
 	VertexShader m_vert;
@@ -34,9 +87,15 @@ class Program
 
 	GLint m_glId;
 
-	std::unordered_map<std::string,Program::UniformData> m_uniformPool;
+	std::vector<Program::UniformData> m_uniformPool;
+	std::unordered_map<std::string,size_t,UniformNameHash,std::equal_to<>> m_uniformIndices;
+	std::vector<std::byte> m_uniformArena;
+	std::vector<std::byte> m_uploadedArena; // what the GL program holds, to skip unchanged values
+	std::vector<size_t> m_dirtyUniforms;
+	UniformUploadStats m_uploadStats;
 
-	std::vector<Program::TextureData> m_texturePool;
+	std::vector<Program::SamplerBinding> m_samplers; // m_samplers[i] uses unit i
+	std::unordered_map<std::string,size_t,UniformNameHash,std::equal_to<>> m_samplerIndices;
 
 public:
 	Program(VertexShader&& vert_shad, FragmentShader&& frag_shad);
@@ -86,27 +145,83 @@ public:
 
 	void setUniformMat4fv(const char* name, float matrix[16]);
 
+	// Samplers keep their texture until it is replaced, setting them once is enough
 	void setUniformTexture2D(const char* name,Texture& texture);
+	void setUniformTexture2DArray(const char* name,const TextureArray& textures);
+
+	// Connects the named uniform block to a binding point, see UniformBlock
+	void bindUniformBlock(const char* blockName, GLuint bindingPoint);
+
+	// Resolves name once, the returned handle sets the uniform without any lookup
+	template<typename T>
+	UniformHandle<T> getUniformHandle(const char* name) const {
+		auto it = m_uniformIndices.find(std::string_view(name));
+		if (it == m_uniformIndices.end())
+			return UniformHandle<T>();
+
+		checkUniformType(m_uniformPool[it->second], UniformTraits<T>::glType, UniformTraits<T>::count, name);
+		return UniformHandle<T>(it->second);
+	}
+
+	template<typename T>
+	void setUniform(UniformHandle<T> handle, const T& value) {
+		if (!handle.isValid())
+			return;
+		writeUniformData(handle.m_index, UniformTraits<T>::count,
+			reinterpret_cast<const typename UniformTraits<T>::Component*>(&value));
+	}
 
 	void clearUniforms();
 
+	const UniformUploadStats& getUniformUploadStats() const {return m_uploadStats;}
+	void resetUniformUploadStats() {m_uploadStats = UniformUploadStats();}
+
 	void useProgram();
 
+	void setLabel(std::string_view label) const;
+
 	~Program();
 
 	Program(Program&) = delete;
 
 private:
 	static void attachGlShader(GLint glProgramId, VertexShader& vs, FragmentShader& fs);
+	void reflectUniforms();
+	static bool uniformComponents(GLenum glUniformType, GLenum& glType, size_t& count);
+	static GLenum samplerTarget(GLenum glUniformType);
+	void assignTextureUnits();
+	void setSamplerTexture(const char* name, GLenum target, GLuint textureId);
 
 	template<typename T> void setUniformData(const char* name, GLenum glType, size_t number ,T* data);
+	static void checkUniformType(const UniformData& ud, GLenum glType, size_t count, const char* name);
+
+	template<typename T>
+	void writeUniformData(size_t index, size_t count, const T* data) {
+		UniformData& ud = m_uniformPool[index];
+		if (!ud.dirty) {
+			ud.dirty = true;
+			m_dirtyUniforms.push_back(index);
+		}
+
+		std::byte* slot = m_uniformArena.data() + ud.offset;
+		if constexpr (std::is_same_v<T, bool>) {
+			// bool uniforms are uploaded with glUniform*i, store them as GLint
+			for (size_t i = 0; i < count; i++) {
+				GLint value = data[i];
+				std::memcpy(slot + i * sizeof(GLint), &value, sizeof(GLint));
+			}
+		} else {
+			static_assert(sizeof(T) == 4, "uniform components are 32 bits wide");
+			std::memcpy(slot, data, count * sizeof(T));
+		}
+	}
 	void useUniformData();
 
-	static void useUniformData1 (GLuint glLocation,GLenum glType, std::byte* data);
-	static void useUniformData2 (GLuint glLocation,GLenum glType, std::byte* data);
-	static void useUniformData3 (GLuint glLocation,GLenum glType, std::byte* data);
-	static void useUniformData4 (GLuint glLocation,GLenum glType, std::byte* data);
-	static void useUniformData9 (GLuint glLocation,GLenum glType, std::byte* data);
-	static void useUniformData16(GLuint glLocation,GLenum glType, std::byte* data);
+	static void useUniformData1 (GLint glLocation,GLenum glType, const std::byte* data);
+	static void useUniformData2 (GLint glLocation,GLenum glType, const std::byte* data);
+	static void useUniformData3 (GLint glLocation,GLenum glType, const std::byte* data);
+	static void useUniformData4 (GLint glLocation,GLenum glType, const std::byte* data);
+	static void useUniformData9 (GLint glLocation,GLenum glType, const std::byte* data);
+	static void useUniformData16(GLint glLocation,GLenum glType, const std::byte* data);
 
 };
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Program.hpp"
+#include "VertexArray.hpp"
+
+// -- Submissions --
+
+struct DrawSubmission {
+    Program* program;
+    const VertexArray* vertexArray;
+    // bound to textureUnit after the program's own samplers, 0 keeps them
+    GLuint texture = 0;
+    GLenum textureTarget = GL_TEXTURE_2D;
+    GLuint textureUnit = 0;
+    // view space distance, sorts opaque draws front to back and transparent
+    // ones back to front
+    float depth = 0.0f;
+    bool transparent = false;
+    // 0 is a plain draw
+    GLsizei instanceCount = 0;
+    GLenum mode = GL_TRIANGLES;
+};
+
+// State changes issued by the last flush
+struct RenderQueueStats {
+    size_t draws = 0;
+    size_t programChanges = 0;
+    size_t vertexArrayChanges = 0;
+    size_t textureChanges = 0;
+};
+
+// -- Queue --
+
+// Draws collected over a frame and issued in the order of a 64 bit key:
+//   opaque      : 0 | program (10) | texture (12) | VAO (12) | depth (24) | 5 unused
+//   transparent : 1 | ~depth (24) | program (10) | texture (12) | VAO (12) | 5 unused
+// so opaque draws are grouped by state then go front to back, and transparent
+// ones (drawn last, blended, without depth writes) go back to front.
+// Programs, textures and VAOs get a small index the first time they are
+// submitted, which is kept for the life of the queue.
+// Uniforms are per program, not per draw: set them before flush().
+class RenderQueue
+{
+public:
+    static constexpr size_t MAX_PROGRAMS = 1 << 10;
+    static constexpr size_t MAX_TEXTURES = 1 << 12;
+    static constexpr size_t MAX_VERTEX_ARRAYS = 1 << 12;
+
+private:
+    struct SortItem {
+        uint64_t key;
+        uint32_t index; // in m_submissions
+    };
+
+    std::vector<DrawSubmission> m_submissions;
+    std::vector<SortItem> m_items;
+    std::vector<SortItem> m_scratch;
+
+    std::unordered_map<const Program*, uint64_t> m_programIndices;
+    std::unordered_map<GLuint, uint64_t> m_textureIndices;
+    std::unordered_map<const VertexArray*, uint64_t> m_vertexArrayIndices;
+
+    RenderQueueStats m_stats;
+
+public:
+    // -- Methods --
+
+    // @throws std::runtime_error past MAX_PROGRAMS, MAX_TEXTURES or
+    // MAX_VERTEX_ARRAYS distinct objects
+    void submit(const DrawSubmission& submission);
+
+    // Sorts and draws everything submitted since the last flush, then empties
+    // the queue. Leaves blending off and depth writes on
+    void flush();
+
+    // -- Getters --
+    size_t getSize() const { return m_submissions.size(); }
+    const RenderQueueStats& getStats() const { return m_stats; }
+
+private:
+    // -- Private methods --
+    uint64_t makeKey(const DrawSubmission& submission);
+
+    // LSD radix sort, keeps the order of equal keys and skips the 8 bit
+    // digits every key shares
+    static void radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <type_traits>
+
+// -- std140 layout rules --
+
+// Base alignment of a block member type under std140, and whether the C++ type
+// has the same size and stride as its GLSL counterpart.
+// Structs and arrays are aligned to a vec4 and must be padded to a multiple of it.
+template <typename T>
+struct Std140 {
+    static constexpr size_t alignment = 16;
+    static constexpr bool valid = std::is_class_v<T> && sizeof(T) % 16 == 0;
+};
+
+template <> struct Std140<float>        { static constexpr size_t alignment = 4; static constexpr bool valid = true; };
+template <> struct Std140<int>          { static constexpr size_t alignment = 4; static constexpr bool valid = true; };
+template <> struct Std140<unsigned int> { static constexpr size_t alignment = 4; static constexpr bool valid = true; };
+
+template <typename T, glm::qualifier Q>
+struct Std140<glm::vec<2, T, Q>> { static constexpr size_t alignment = 8; static constexpr bool valid = Std140<T>::valid; };
+template <typename T, glm::qualifier Q>
+struct Std140<glm::vec<3, T, Q>> { static constexpr size_t alignment = 16; static constexpr bool valid = Std140<T>::valid; };
+template <typename T, glm::qualifier Q>
+struct Std140<glm::vec<4, T, Q>> { static constexpr size_t alignment = 16; static constexpr bool valid = Std140<T>::valid; };
+
+// Matrix columns are vec4 aligned, only 4 rows matrices match the C++ layout
+template <glm::length_t C, glm::length_t R, glm::qualifier Q>
+struct Std140<glm::mat<C, R, float, Q>> { static constexpr size_t alignment = 16; static constexpr bool valid = R == 4; };
+
+template <typename T, size_t N>
+struct Std140<T[N]> {
+    static constexpr size_t alignment = 16;
+    static constexpr bool valid = Std140<T>::valid && sizeof(T) % 16 == 0;
+};
+
+// Checks at compile time that a member sits at `offset`, its std140 offset in
+// the GLSL block, vec3/vec4/mat/struct members usually need an alignas(16)
+#define STD140_CHECK_MEMBER(Block, member, offset)                                           \
+    static_assert(Std140<decltype(Block::member)>::valid,                                    \
+                  #Block "::" #member " has no std140 equivalent");                          \
+    static_assert(offsetof(Block, member) % Std140<decltype(Block::member)>::alignment == 0, \
+                  #Block "::" #member " is not std140 aligned");                             \
+    static_assert(offsetof(Block, member) == (offset), #Block "::" #member " is not at its std140 offset")
@@ -1,10 +1,26 @@
 #pragma  once
 
 #include <glad/glad.h>
+#include <memory>
+#include <string_view>
 #include <vector>
 
+#include "Dds.hpp"
 #include "gl_utils.hpp"
 
+// Frees pixels allocated by stbi
+struct StbiDeleter {
+    void operator()(unsigned char* pixels) const;
+};
+
+// Image decoded on the CPU, ready for Texture::setImage or TextureArray::padImage
+struct DecodedImage {
+    std::unique_ptr<unsigned char, StbiDeleter> pixels;
+    GLsizei width;
+    GLsizei height;
+    size_t size; // bytes
+};
+
 class Texture
 {
 private:
@@ -13,13 +29,16 @@ private:
     GLsizei m_width;
     GLsizei m_height;
     GLenum  m_format;
-    std::vector<unsigned char> m_data;
     
 public:
     // -- Constructors --
-    Texture(GLint internalformat,GLsizei width,GLsizei height,GLenum format,const std::vector<unsigned char> data);
+    // The pixels are uploaded right away and no CPU copy is kept, the caller
+    // (or stbi for the path constructor) keeps ownership of the data
+    Texture(GLint internalformat,GLsizei width,GLsizei height,GLenum format,const std::vector<unsigned char>& data);
     Texture(GLint internalformat,GLsizei width,GLsizei height,GLenum format,const unsigned char* data);
     Texture(const char* path,GLint internalFormat,GLint format);
+    // Block compressed texture, every level of the file is uploaded as is
+    explicit Texture(const DdsFile& file);
     
 	Texture& operator=(Texture&& other) noexcept;
 	Texture(Texture&& other) noexcept;
@@ -31,15 +50,31 @@ public:
     ~Texture();
 
     // -- Getters --
-    GLuint getGlId();
+    GLuint getGlId() const;
+    GLenum getFormat() const { return m_format; }
+
     // -- Methods --
+
+    // Replaces the pixels (and size) of the texture, the GL id stays the same so
+    // the texture can stand as a placeholder until the real image is decoded.
+    // With a pixel unpack buffer bound, `data` is an offset in that buffer
+    void setImage(GLsizei width, GLsizei height, const unsigned char* data);
+
+    // The pixels are not kept, a deleted texture cannot be recreated
     void deleteGlTexture();
 
+    void setLabel(std::string_view label) const;
+
 private:
     // -- Private methods --
-    void createGlTexture();
+    void createGlTexture(const unsigned char* data);
 
     //-- Utils --
+public:
+    // Decodes `path` flipped vertically with the channels of `format`.
+    // Touches no GL state, can run on any thread
+    static DecodedImage decodeImage(const char* path, GLenum format);
+private:
     static constexpr size_t bytePerPixel(GLenum format, GLenum type); 
     
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma  once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string_view>
+#include <vector>
+
+#include "Texture.hpp"
+
+// Images of different sizes packed in the layers of one GL_TEXTURE_2D_ARRAY,
+// filled by TextureLoader.
+// Every layer is as large as the largest image, an image sits in the bottom
+// left corner of its layer and its UVs must be scaled by getUvScale(layer).
+// The rest of the layer repeats the image border so filtering and mipmaps do
+// not bleed into the padding.
+class TextureArray
+{
+public:
+    static constexpr size_t BYTES_PER_PIXEL = 4; // layers are uploaded as RGBA
+
+private:
+    GLuint  m_glId;
+    GLint   m_internalFormat;
+    GLsizei m_width;
+    GLsizei m_height;
+    std::vector<glm::vec2> m_uvScales;
+
+public:
+    // -- Constructors --
+    // layerCount layers of a single black pixel, placeholders until the
+    // images are uploaded
+    explicit TextureArray(GLsizei layerCount, GLint internalFormat = GL_RGBA8);
+
+    TextureArray(TextureArray&& other) noexcept;
+    TextureArray& operator=(TextureArray&& other) noexcept;
+
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    // -- Destructor --
+    ~TextureArray();
+
+    // -- Getters --
+    GLuint getGlId() const { return m_glId; }
+    GLsizei getWidth() const { return m_width; }
+    GLsizei getHeight() const { return m_height; }
+    GLsizei getLayerCount() const { return static_cast<GLsizei>(m_uvScales.size()); }
+    glm::vec2 getUvScale(GLsizei layer) const { return m_uvScales[layer]; }
+    // bytes of a padded layer, see padImage
+    size_t getLayerSize() const { return size_t(m_width) * m_height * BYTES_PER_PIXEL; }
+
+    // -- Methods --
+
+    // Reallocates every layer at width x height, the GL id stays. The array
+    // has no mipmaps until generateMipmaps(), it samples as black meanwhile
+    void allocate(GLsizei width, GLsizei height);
+
+    // Replaces the pixels of `layer` with a full layer holding an image of
+    // imageWidth x imageHeight padded by padImage.
+    // With a pixel unpack buffer bound, `pixels` is an offset in that buffer
+    void setLayer(GLint layer, GLsizei imageWidth, GLsizei imageHeight, const unsigned char* pixels);
+
+    // Rebuilds the mip chain from the layers, once they are all set
+    void generateMipmaps();
+
+    void setLabel(std::string_view label) const;
+
+    //-- Utils --
+
+    // Copies `image` (decoded with GL_RGBA) in the corner of a width x height
+    // layer and fills the rest with its last column/row. Touches no GL state,
+    // can run on any thread
+    static void padImage(const DecodedImage& image, GLsizei width, GLsizei height, unsigned char* layer);
+};
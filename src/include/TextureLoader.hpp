@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "PixelUploadRing.hpp"
+#include "Texture.hpp"
+#include "TextureArray.hpp"
+#include "ThreadPool.hpp"
+
+// Decodes images on a thread pool and streams them to their textures or to
+// the layers of their texture arrays. The targets keep their current
+// (placeholder) pixels until uploadReady() picks their images up.
+//
+// Each texture goes through:
+//   decoding on a worker -> waiting for a free slot of the upload ring ->
+//   copy into the mapped slot on a worker -> GPU copy into the texture
+// Each array goes through:
+//   decoding every layer on workers -> reallocating the array at the size of
+//   the largest image -> per layer: waiting for a free slot of the upload
+//   ring -> padding into the mapped slot on a worker -> GPU copy into the
+//   layer -> mipmaps once every layer is in
+// the GL thread only allocates, maps, unmaps and issues the copies.
+class TextureLoader
+{
+private:
+    struct PendingTexture {
+        Texture* target;
+        std::future<DecodedImage> decoding;
+        DecodedImage image; // waiting for a ring slot once decoded
+
+        // set once a ring slot is being filled
+        int slot;
+        std::future<void> copying;
+    };
+
+    struct LayerCopy {
+        GLint layer;
+        int slot;
+        std::future<void> copying;
+    };
+
+    struct PendingArray {
+        TextureArray* target;
+        std::vector<std::future<DecodedImage>> decoding; // emptied once every layer is decoded
+        std::vector<DecodedImage> images;
+
+        size_t nextLayer; // the next one waiting for a ring slot
+        std::vector<LayerCopy> copies;
+        size_t uploadedCount;
+    };
+
+    ThreadPool& m_pool;
+    PixelUploadRing m_ring;
+    std::vector<PendingTexture> m_pendingTextures;
+    std::vector<PendingArray> m_pendingArrays;
+
+public:
+    // -- Constructors --
+    explicit TextureLoader(ThreadPool& pool, size_t ringSlots = 3);
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // -- Destructor --
+    // Waits for the copies in flight, they write into the ring mappings
+    ~TextureLoader();
+
+    // -- Getters --
+    size_t getPendingCount() const { return m_pendingTextures.size() + m_pendingArrays.size(); }
+
+    // -- Methods --
+
+    // Starts decoding `path` with the format of `target`, which must outlive
+    // the request
+    void load(Texture& target, const char* path);
+
+    // Starts decoding paths[i] for layer i of `target`, which must outlive
+    // the request and have a layer per path
+    void load(TextureArray& target, const std::vector<std::string>& paths);
+
+    // GL thread only, moves every request forward without waiting.
+    // Decoding errors are rethrown here, the failed request is dropped and
+    // the others stay pending.
+    // @returns the number of textures and arrays updated, the UV scales of
+    // the arrays changed
+    size_t uploadReady();
+
+    // GL thread only, waits for and uploads every pending image
+    void uploadAll();
+
+private:
+    // Advances every request of `pending`, @returns the number done
+    template <typename Pending>
+    size_t advanceAll(std::vector<Pending>& pending);
+
+    // @returns true when the request is done
+    bool advance(PendingTexture& pending);
+    bool advance(PendingArray& pending);
+
+    // Drops pending[index] once no worker writes for it anymore
+    static void remove(std::vector<PendingTexture>& pending, size_t index);
+    static void remove(std::vector<PendingArray>& pending, size_t index);
+};
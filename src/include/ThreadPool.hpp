@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads consuming a FIFO of jobs.
+// Jobs must not touch GL, the context only lives on the main thread.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_jobs;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    bool m_stopping;
+
+public:
+    // -- Constructors --
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(size_t threadCount = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // -- Destructor --
+    // Finishes the queued jobs before joining
+    ~ThreadPool();
+
+    // -- Getters --
+    size_t getThreadCount() const { return m_workers.size(); }
+
+    // -- Methods --
+
+    // Queues `job`, its result (or exception) is reported through the future
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& job) {
+        using R = std::invoke_result_t<F>;
+
+        // std::function needs a copyable callable, the task is shared
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(job));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.emplace([task]() { (*task)(); });
+        }
+        m_jobAvailable.notify_one();
+        return result;
+    }
+
+private:
+    void workerLoop();
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <type_traits>
+
+#include "GlBuffer.hpp"
+#include "Std140.hpp"
+#include "gl_utils.hpp"
+
+// -- Uniform block --
+
+// CPU copy of a std140 uniform block and the uniform buffer backing it.
+// Programs reach it through its binding point, see Program::bindUniformBlock.
+template <typename T>
+class UniformBlock
+{
+    static_assert(std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T>,
+                  "uniform blocks are copied as raw bytes");
+    static_assert(sizeof(T) % 16 == 0, "std140 blocks are padded to a multiple of a vec4");
+
+private:
+    T m_data;
+    UniformBuffer<std::byte> m_buffer;
+    GLuint m_bindingPoint;
+
+public:
+    // -- Constructors --
+    explicit UniformBlock(GLuint bindingPoint)
+        : m_data(), m_buffer(), m_bindingPoint(bindingPoint)
+    {
+        m_buffer.uploadData(reinterpret_cast<const std::byte*>(&m_data), sizeof(T), GL_DYNAMIC_DRAW);
+        m_buffer.bindBase(m_bindingPoint);
+    }
+
+    UniformBlock(const UniformBlock&) = delete;
+    UniformBlock& operator=(const UniformBlock&) = delete;
+
+    // -- Getters --
+    T& get() { return m_data; }
+    const T& get() const { return m_data; }
+    GLuint getBindingPoint() const { return m_bindingPoint; }
+    GLuint getBufferId() const { return m_buffer.getGlId(); }
+
+    // -- Methods --
+
+    // Sends the whole block, meant to be called once per frame after filling get()
+    void upload() { m_buffer.uploadSubData(reinterpret_cast<const std::byte*>(&m_data), sizeof(T), 0); }
+};
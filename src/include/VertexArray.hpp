@@ -1,11 +1,24 @@
 #pragma once
 
+#include <string_view>
+#include <variant>
+
 #include "GlBuffer.hpp"
 #include "VertexLayout.hpp"
 
 class VertexArray {
  private:
+  using IndexBufferVariant =
+      std::variant<std::monostate, IndexBuffer<GLubyte>, IndexBuffer<GLushort>,
+                   IndexBuffer<GLuint>>;
+
   GLuint m_glId;
+  GLuint m_attribCount;
+  GLsizei m_vertexCount;
+
+  IndexBufferVariant m_indexBuffer;
+  GLenum m_indexType;
+  GLsizei m_indexCount;
 
  public:
   //-- Constructors --
@@ -26,19 +39,39 @@ class VertexArray {
   void bind() const;
   void unbind() const;
 
+  // Binds the VAO, glGenVertexArrays only creates it on the first bind
+  void setLabel(std::string_view label) const;
+
+  // Uploads indices with the smallest type that holds them, draw() then uses
+  // glDrawElements
+  void setIndices(const GLuint* indices, size_t count);
+  // Uploads indices already stored as `indexType` (GL_UNSIGNED_BYTE, _SHORT or
+  // _INT) without converting them
+  void setIndices(GLenum indexType, const void* indices, size_t count);
+
+  void draw(GLenum mode = GL_TRIANGLES) const;
+  void drawInstanced(GLsizei instanceCount, GLenum mode = GL_TRIANGLES) const;
+
   template <typename T>
   void addBuffer(const VertexBuffer<T>& vb, const VertexLayout& layout) {
     bind();
     vb.bind();
 
+    // attributes of successive buffers follow each other
     const auto& elements = layout.getElements();
     const size_t stride = layout.getStride();
-    size_t i = 0;
+    if (layout.getDivisor() == 0)
+      m_vertexCount = vb.getCount() * sizeof(T) / stride;
+
+    GLuint& i = m_attribCount;
     size_t offset = 0;
     for (const auto& element : elements) {
       glCall(glVertexAttribPointer(i, element.count, element.glType,
                                    element.normalized, stride, (void*)offset));
       glCall(glEnableVertexAttribArray(i));
+      if (layout.getDivisor() != 0) {
+        glCall(glVertexAttribDivisor(i, layout.getDivisor()));
+      }
       offset += glTypeSize(element.glType) * element.count;
       i++;
     }
@@ -16,16 +16,29 @@ class VertexLayout {
  private:
   std::vector<VertexElement> m_elements;
   size_t m_stride;
+  GLuint m_divisor;
 
  public:
   //-- Constructors --
-  VertexLayout() : m_stride(0) {};
+  VertexLayout() : m_stride(0), m_divisor(0) {};
+  // divisor > 0 makes every attribute of the layout advance once per
+  // `divisor` instances instead of once per vertex
+  explicit VertexLayout(GLuint divisor) : m_stride(0), m_divisor(divisor) {};
 
   // -- Getters --
   const std::vector<VertexElement>& getElements() const { return m_elements; }
   size_t getStride() const { return m_stride; }
+  GLuint getDivisor() const { return m_divisor; }
 
   // -- Methodes --
+
+  // Appends an element described at run time, e.g. read from a mesh file
+  VertexLayout& push(const VertexElement& element) {
+    m_elements.push_back(element);
+    m_stride += element.count * glTypeSize(element.glType);
+    return *this;
+  }
+
   template <typename T>
   void push(size_t count, bool normalized) {
     throw std::runtime_error("push is not implemented for this type");
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <glad/glad.h>
+
 #include <cstddef>
 #include <glm/vec3.hpp>
 
 // - Meshes cst -
+// non indexed, welded into an indexed mesh at load time (see weldVertices)
 const size_t VERTICES_SIZE = 288;
+const size_t VERTICES_STRIDE = 8;
 float vertices[VERTICES_SIZE] = {
     //|Positions         //|Normals                 //|Text coord
     -0.5f, -0.5f, -0.5f, /*|*/ 0.0f,  0.0f,  -1.0f, /*|*/ 0.0f, 0.0f,
@@ -49,30 +53,6 @@ float vertices[VERTICES_SIZE] = {
     -0.5f, 0.5f,  0.5f,  /*|*/ 0.0f,  1.0f,  0.0f,  /*|*/ 0.0f, 0.0f,
     -0.5f, 0.5f,  -0.5f, /*|*/ 0.0f,  1.0f,  0.0f,  /*|*/ 0.0f, 1.0f};
 
-/*
-const float cubeVertices[] = {
-    //Positions        //|Normals
-     1.0f,  1.0f, -1.0f,
-     1.0f, -1.0f, -1.0f,
-     1.0f,  1.0f,  1.0f,
-     1.0f, -1.0f,  1.0f,
-    -1.0f,  1.0f, -1.0f,
-    -1.0f, -1.0f, -1.0f,
-    -1.0f,  1.0f,  1.0f,
-    -1.0f, -1.0f,  1.0f,
-};
-
-const unsigned int CUBE_INDICE_SIZE = 24;
-const unsigned int cubeIndices[CUBE_INDICE_SIZE]{
-    1, 5, 7, 3,
-    4, 3, 7, 8,
-    8, 7, 5, 6,
-    6, 2, 4, 8,
-    2, 1, 3, 4,
-    6, 5, 1, 2
-};
-*/
-
 const int CUBE_POSITION_NUMBER = 10;
 glm::vec3 cubePositions[CUBE_POSITION_NUMBER] = {
     glm::vec3(0.0f, 0.0f, 0.0f),    glm::vec3(2.0f, 5.0f, -15.0f),
@@ -86,6 +66,14 @@ glm::vec3 pointLightPositions[POINT_LIGHT_POSITION_NUMBER] = {
     glm::vec3(0.7f, 0.2f, 2.0f), glm::vec3(2.3f, -3.3f, -4.0f),
     glm::vec3(-4.0f, 2.0f, -12.0f), glm::vec3(0.0f, 0.0f, -3.0f)};
 
+// - Uniform block binding points -
+const GLuint LIGHTING_BLOCK_BINDING = 0;
+const GLuint CAMERA_BLOCK_BINDING = 1;
+
+// - Material maps -
+// must match MAX_MATERIAL_LAYERS in cube.frag
+const int MAX_MATERIAL_LAYERS = 16;
+
 // - Shaders cst -
 extern const char* cubeFragShaderSrc;
 extern const char* cubeVertShaderSrc;
@@ -10,6 +10,17 @@
 #include <stdexcept>
 
 
+// -- Extension enums --
+
+// glad is generated for the 3.3 core profile only, EXT_texture_compression_s3tc
+// is supported by every desktop driver but its enums are missing
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 // -- Memory utils --
 
 inline constexpr size_t glTypeSize(GLenum glType)
@@ -43,6 +54,43 @@ inline constexpr size_t glTypeSize(GLenum glType)
     }
 }
 
+// Bytes per 4x4 block of a block compressed format, 0 if not compressed
+inline constexpr size_t glCompressedBlockSize(GLenum internalFormat)
+{
+    switch(internalFormat)
+    {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+// Bytes of a width x height image in a block compressed format
+inline constexpr size_t glCompressedImageSize(GLenum internalFormat, size_t width, size_t height)
+{
+    return ((width + 3) / 4) * ((height + 3) / 4) * glCompressedBlockSize(internalFormat);
+}
+
+// -- glCall checking levels --
+
+// GL_CHECK_OFF    : glCall(x) is x and throwOnGlError does nothing, errors
+//                   are only seen by the KHR_debug callback (see GlDebug.hpp)
+// GL_CHECK_ASSERT : one glGetError per call, aborts on the first error
+// GL_CHECK_FULL   : one glGetError per call, throws with every pending error
+// The level is picked by the GL_CHECK_LEVEL CMake cache variable
+#define GL_CHECK_OFF    0
+#define GL_CHECK_ASSERT 1
+#define GL_CHECK_FULL   2
+
+#ifndef GL_CHECK_LEVEL
+#define GL_CHECK_LEVEL GL_CHECK_FULL
+#endif
+
 // -- Error handling --
 
 //derive from openGL doc : registry.khronos.org/OpenGL-Refpages/gl4/html/glGetError.xhtml
@@ -59,6 +107,29 @@ static const char * MSG_GL_OUT_OF_MEMORY =                 "Error code [0x0505]
 static const char * MSG_GL_INVALID_FRAMEBUFFER_OPERATION = "Error code [0x0506] :\t The framebuffer object is not complete. The offending command is ignored and has no other side effect than to set the error flag.\n";
 #define MSG_UNKNOWN_GL_ERROR                        "Error code [0x%04X] :\t An unknown error has been detected.\n"
 
+// Appends the description of `error` to `out`
+inline void appendGlError(std::string& out, GLenum error){
+    switch (error)
+    {
+        case GL_INVALID_ENUM                    : out += MSG_GL_INVALID_ENUM; break; 
+        case GL_INVALID_VALUE                   : out += MSG_GL_INVALID_VALUE; break; 
+        case GL_INVALID_OPERATION               : out += MSG_GL_INVALID_OPERATION; break; 
+        #ifdef MSG_GL_STACK_UNDERFLOW
+            case GL_STACK_OVERFLOW              : out += MSG_GL_STACK_OVERFLOW; break;  
+        #endif        
+        #ifdef MSG_GL_STACK_OVERFLOW
+            case GL_STACK_UNDERFLOW             : out += MSG_GL_STACK_UNDERFLOW; break; 
+        #endif
+        case GL_OUT_OF_MEMORY                   : out += MSG_GL_OUT_OF_MEMORY; break; 
+        case GL_INVALID_FRAMEBUFFER_OPERATION   : out += MSG_GL_INVALID_FRAMEBUFFER_OPERATION; break; 
+        default: 
+            char buffer[128];
+            snprintf(buffer, sizeof(buffer),MSG_UNKNOWN_GL_ERROR, error);
+            out += buffer;
+            break;
+    }
+}
+
 // @returns the error code in case of an error, 0 if no error
 inline GLenum logOnGlError(std::ostream& stream,const char * errorMsg){
     GLenum error = glGetError();
@@ -68,26 +139,7 @@ inline GLenum logOnGlError(std::ostream& stream,const char * errorMsg){
         std::string throwError(errorMsg);
         throwError += '\n';
         do{
-
-            switch (error)
-            {
-                case GL_INVALID_ENUM                    : throwError += MSG_GL_INVALID_ENUM; break; 
-                case GL_INVALID_VALUE                   : throwError += MSG_GL_INVALID_VALUE; break; 
-                case GL_INVALID_OPERATION               : throwError += MSG_GL_INVALID_OPERATION; break; 
-                #ifdef MSG_GL_STACK_UNDERFLOW
-                    case GL_STACK_OVERFLOW              : throwError += MSG_GL_STACK_OVERFLOW; break;  
-                #endif        
-                #ifdef MSG_GL_STACK_OVERFLOW
-                    case GL_STACK_UNDERFLOW             : throwError += MSG_GL_STACK_UNDERFLOW; break; 
-                #endif
-                case GL_OUT_OF_MEMORY                   : throwError += MSG_GL_OUT_OF_MEMORY; break; 
-                case GL_INVALID_FRAMEBUFFER_OPERATION   : throwError += MSG_GL_INVALID_FRAMEBUFFER_OPERATION; break; 
-                default: 
-                    char buffer[128];
-                    snprintf(buffer, sizeof(buffer),MSG_UNKNOWN_GL_ERROR, error);
-                    throwError += buffer;
-                    break;
-            }
+            appendGlError(throwError, error);
             error = glGetError();
         }while(error != GL_NO_ERROR);
 
@@ -97,20 +149,40 @@ inline GLenum logOnGlError(std::ostream& stream,const char * errorMsg){
 }
 
 inline void throwOnGlError(const char * errorMsg){
+#if GL_CHECK_LEVEL == GL_CHECK_OFF
+    // glGetError may sync with the driver, release builds rely on KHR_debug
+    (void)errorMsg;
+#else
     std::stringstream errorStream;
 
     if(logOnGlError(errorStream,errorMsg)){
         std::string error = errorStream.str();
         throw std::runtime_error(error);
     }
+#endif
 }
 
+// Failure paths of glCall, kept out of line so the call sites only pay for
+// glGetError and a compare. `error` is the code glCall already popped.
+// Defined in GlDebug.cpp
+[[noreturn]] void glCallAbort(GLenum error, const char* call, const char* file, int line);
+[[noreturn]] void glCallThrow(GLenum error, const char* call, const char* file, int line);
+
+#if GL_CHECK_LEVEL == GL_CHECK_OFF
+#define glCall(x) x
+#elif GL_CHECK_LEVEL == GL_CHECK_ASSERT
 #define glCall(x) \
     x;{\
-    std::stringstream errorStream;\
-    errorStream << "GL ERROR in " << #x << "at :" << __FILE__ << "::" << __LINE__ << "\n";\
-    if(logOnGlError(errorStream, ""))\
-        throw std::runtime_error(errorStream.str());}
+    GLenum glCallError = glGetError();\
+    if(glCallError != GL_NO_ERROR)\
+        glCallAbort(glCallError, #x, __FILE__, __LINE__);}
+#else
+#define glCall(x) \
+    x;{\
+    GLenum glCallError = glGetError();\
+    if(glCallError != GL_NO_ERROR)\
+        glCallThrow(glCallError, #x, __FILE__, __LINE__);}
+#endif
 
 // -- Math --
 
@@ -9,11 +9,34 @@ Copyright 2025 Corentin Vaillant
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <future>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
 
+#include "Bvh.hpp"
 #include "Camera.hpp"
+#include "CommandList.hpp"
+#include "Culling.hpp"
+#include "Framebuffer.hpp"
 #include "GlBuffer.hpp"
+#include "GlDebug.hpp"
+#include "GlState.hpp"
+#include "Lighting.hpp"
+#include "Mesh.hpp"
+#include "MeshFile.hpp"
+#include "Profiler.hpp"
 #include "Program.hpp"
+#include "RenderQueue.hpp"
+#include "TextureArray.hpp"
+#include "TextureLoader.hpp"
+#include "ThreadPool.hpp"
+#include "UniformBlock.hpp"
 #include "VertexArray.hpp"
 #include "constants.hpp"
 #include "gl_utils.hpp"
@@ -33,28 +56,97 @@ float cursorLastX, cursorLastY, cameraYaw, cameraPitch;
 
 bool firstMouse;
 
+// Run options
+
+struct RunOptions {
+  // renders into an offscreen framebuffer of an invisible window, no vsync
+  // and a fixed time step
+  bool headless = false;
+  // stops after that many frames, 0 runs until the window is closed
+  long frames = 0;
+  // writes every frame as frame_NNNNN.png in that directory, headless only
+  const char* captureDir = nullptr;
+};
+
+// headless frames advance the clock by this much whatever their real duration
+const float HEADLESS_FRAME_TIME = 1.0f / 60.0f;
+const long HEADLESS_DEFAULT_FRAMES = 300;
+
 // -- Functions --
 void mouse_callback(GLFWwindow*, double xpos, double ypos);
 void framebuffer_size_callback(GLFWwindow*, int width, int height);
 
 // -- Initializers --
 
-void initGlfw() {
+void printUsage(const char* program) {
+  std::cerr << "usage : " << program
+            << " [--headless] [--frames N] [--capture directory]\n"
+               "  --headless  render offscreen without vsync and with a fixed "
+               "time step\n"
+               "  --frames N  stop after N frames (default "
+            << HEADLESS_DEFAULT_FRAMES << " when headless)\n"
+               "  --capture   write every frame as a PNG, implies --headless"
+            << std::endl;
+}
+
+RunOptions parseOptions(int argc, char** argv) {
+  RunOptions options;
+  for (int i(1); i < argc; i++) {
+    if (std::strcmp(argv[i], "--headless") == 0) {
+      options.headless = true;
+    } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      char* end;
+      options.frames = std::strtol(argv[++i], &end, 10);
+      expect_true(*end == '\0' && options.frames > 0,
+                  "--frames expects a positive number", -1);
+    } else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+      options.captureDir = argv[++i];
+      options.headless = true;
+    } else {
+      printUsage(argv[0]);
+      exit(-1);
+    }
+  }
+
+  if (options.headless && options.frames == 0)
+    options.frames = HEADLESS_DEFAULT_FRAMES;
+  return options;
+}
+
+void initGlfw(bool headless) {
   expect_true(glfwInit(), "Failed to initialize GLFW", -1);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if GL_CHECK_LEVEL != GL_CHECK_OFF
+  // non debug contexts may report only part of the KHR_debug messages
+  glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+  // the window still carries the context, it is just never shown
+  if (headless)
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 }
 
-GLFWwindow* initWindow() {
+GLFWwindow* initWindow(bool headless) {
   auto window = glfwCreateWindow(800, 600, "LearnOpenGL", NULL, NULL);
   expect_ptr(window, "Failed to create GLFW window", -1);
   glfwMakeContextCurrent(window);
   expect_true(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress),
               "Failed to initialize GLAD", -1);
 
+  if (!GlDebugOutput::init((GLADloadproc)glfwGetProcAddress,
+                           GL_DEBUG_SEVERITY_LOW))
+    std::cerr << "GL_KHR_debug unavailable, GL errors are only caught by glCall"
+              << std::endl;
+
   glViewport(0, 0, 800, 600);
 
+  if (headless) {
+    // frames are only bound by the GPU, not the display
+    glfwSwapInterval(0);
+    return window;
+  }
+
   glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
   glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
@@ -106,14 +198,68 @@ void framebuffer_size_callback(GLFWwindow*, int width, int height) {
 }
 
 // -- Utils --
+// center of an instanced group, what the render queue sorts it by
+glm::vec3 centroid(const glm::vec3* points, int count) {
+  glm::vec3 sum(0.0f);
+  for (int i(0); i < count; i++) sum += points[i];
+  return sum / static_cast<float>(count);
+}
+
 glm::vec2 getResolution(GLFWwindow* window) {
   int width, heigth;
   glfwGetWindowSize(window, &width, &heigth);
   return glm::vec2(static_cast<float>(width), static_cast<float>(heigth));
 }
 
+// -- Frame recording --
+// Fills the std140 lighting block of a frame, touches no GL state so it is
+// recorded by a worker
+LightingBlock buildLighting(float time, glm::vec3 clearColor,
+                            glm::vec3 spotPosition, glm::vec3 spotDirection) {
+  LightingBlock lights{};
+
+  // Sun
+  lights.dirLight.direction = glm::vec3(-0.2f, -1.0f, -0.3f);
+  lights.dirLight.ambient = clearColor;
+  lights.dirLight.diffuse = clearColor;
+  lights.dirLight.specular = clearColor;
+
+  // Points
+  for (uint j(0); j < POINT_LIGHT_POSITION_NUMBER; j++) {
+    auto timePalette = palette(time / (j + 2));
+    PointLight& pl = lights.pointLights[j];
+
+    pl.position = pointLightPositions[j];
+    pl.constant = 1.0f;
+    pl.linear = 0.09f;
+    pl.quadratic = 0.032f;
+    pl.ambient = timePalette;
+    pl.diffuse = clearColor;
+    pl.specular = timePalette;
+  }
+
+  // Spot
+  const glm::vec3 CAMERA_SPOT_COLOR(1.0f);
+  SpotLight& spot = lights.spotLight;
+  spot.position = spotPosition;
+  spot.direction = spotDirection;
+  spot.cutOff = glm::cos(glm::radians(12.5f));
+  spot.outerCutOff = glm::cos(glm::radians(15.0f));
+
+  spot.ambient = clearColor;
+  spot.diffuse = CAMERA_SPOT_COLOR;
+  spot.specular = CAMERA_SPOT_COLOR;
+
+  spot.constant = 1.0f;
+  spot.linear = 0.09f;
+  spot.quadratic = 0.032f;
+
+  return lights;
+}
+
 // -- Updates --
-void processInput(GLFWwindow* window) {
+void processInput(GLFWwindow* window, const Profiler& profiler,
+                  const RenderQueue& renderQueue) {
   if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
     glfwSetWindowShouldClose(window, true);
 
@@ -135,44 +281,190 @@ void processInput(GLFWwindow* window) {
   if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
     camera.translate(-camera.getUp() * cameraSpeed);
 
-  if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)
-    std::cout << "[time : " << lastFrame << "] FPS : " << 1.0 / dt << std::endl;
+  if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS) {
+    profiler.printStats(std::cout);
+    const RenderQueueStats& queueStats = renderQueue.getStats();
+    std::cout << "  render queue : " << queueStats.draws << " draws, "
+              << queueStats.programChanges << " program, "
+              << queueStats.vertexArrayChanges << " VAO and "
+              << queueStats.textureChanges << " texture changes" << std::endl;
+    // counters of the previous frame, reset right after the inputs
+    const GlStateStats& stats = GlState::getStats();
+    std::cout << "  GL binds issued/elided : textures "
+              << stats.textures.issued << "/" << stats.textures.elided
+              << ", programs " << stats.programs.issued << "/"
+              << stats.programs.elided << ", VAOs "
+              << stats.vertexArrays.issued << "/" << stats.vertexArrays.elided
+              << ", buffers " << stats.buffers.issued << "/"
+              << stats.buffers.elided << std::endl;
+  }
 }
 
-int main() {
+int main(int argc, char** argv) {
+  const RunOptions options = parseOptions(argc, argv);
+
   // MARK: Init
   {
-    initGlfw();
-    auto window = initWindow();
+    initGlfw(options.headless);
+    auto window = initWindow(options.headless);
 
     //- Init VAO and VBO (vertex array object, vertex buffer object)
 
     VertexArray cubeVAO = VertexArray();
 
-    VertexBuffer<GLfloat> VBO = VertexBuffer<GLfloat>(vertices, VERTICES_SIZE);
+    MeshData cubeMesh = weldVertices(vertices, VERTICES_SIZE / VERTICES_STRIDE,
+                                     VERTICES_STRIDE);
+
+    VertexBuffer<GLfloat> VBO =
+        VertexBuffer<GLfloat>(cubeMesh.vertices.data(), cubeMesh.vertices.size());
 
     VertexLayout layout =
         VertexLayout().push<GLfloat>(3).push<GLfloat>(3).push<GLfloat>(2);
     cubeVAO.addBuffer(VBO, layout);
+    cubeVAO.setIndices(cubeMesh.indices.data(), cubeMesh.indices.size());
 
-    // second, configure the light's VAO (VBO stays the same; the vertices are
-    // the same for the light object which is also a 3D cube)
+    // second, configure the light's VAO, the lamps use the cube exported from
+    // blender (it spans -1 to 1, twice the hard coded one) baked at build time
     VertexArray lightCubeVAO = VertexArray();
 
-    lightCubeVAO.addBuffer(VBO, layout);
-
-    // Textures
-    Texture diffuse("../resources/container2.png", GL_RGBA, GL_RGBA);
-    Texture specular("../resources/container2_specular.png", GL_RGBA, GL_RGBA);
-    Texture emission("../resources/matrix.jpg", GL_RGBA, GL_RGB);
+    MeshFile lampMesh(MESH_DIR "/cube.mesh");
+    VertexBuffer<std::byte> lampVBO = VertexBuffer<std::byte>(
+        lampMesh.getVertices(), lampMesh.getVerticesSize());
+
+    lightCubeVAO.addBuffer(lampVBO, lampMesh.getLayout());
+    lightCubeVAO.setIndices(lampMesh.getIndexType(), lampMesh.getIndices(),
+                            lampMesh.getIndexCount());
+
+    // Per instance model and normal matrices, a mat4 takes four vec4 attributes
+    // and a mat3 three vec3 ones
+    VertexLayout instanceLayout = VertexLayout(1)
+                                      .push<GLfloat>(4)
+                                      .push<GLfloat>(4)
+                                      .push<GLfloat>(4)
+                                      .push<GLfloat>(4)
+                                      .push<GLfloat>(3)
+                                      .push<GLfloat>(3)
+                                      .push<GLfloat>(3);
+    static_assert(sizeof(InstanceTransform) == 25 * sizeof(GLfloat));
+
+    VertexBuffer<InstanceTransform> cubeInstances =
+        VertexBuffer<InstanceTransform>();
+    cubeVAO.addBuffer(cubeInstances, instanceLayout);
+
+    std::vector<Transform> cubeTransforms;
+    for (int i(0); i < CUBE_POSITION_NUMBER; i++)
+      cubeTransforms.emplace_back(cubePositions[i], glm::vec3(1.0f),
+                                  glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+
+    // cubes spin in place, a sphere around the unit cube bounds every
+    // rotation
+    const float CUBE_BOUNDING_RADIUS = std::sqrt(3.0f) * 0.5f;
+    BoundingSpheres cubeBounds;
+    cubeBounds.reserve(CUBE_POSITION_NUMBER);
+    for (int i(0); i < CUBE_POSITION_NUMBER; i++)
+      cubeBounds.push(cubePositions[i], CUBE_BOUNDING_RADIUS);
+    VisibleList visibleCubes;
+
+    // Picking, the tree holds the box around each bounding sphere so it stays
+    // valid whatever the rotation
+    const Aabb CUBE_SPIN_BOUNDS{glm::vec3(-CUBE_BOUNDING_RADIUS),
+                                glm::vec3(CUBE_BOUNDING_RADIUS)};
+    std::vector<Aabb> cubeBoxes;
+    for (const Transform& cubeTransform : cubeTransforms)
+      cubeBoxes.push_back(worldBounds(cubeTransform, CUBE_SPIN_BOUNDS));
+    Bvh cubeBvh;
+    cubeBvh.build(std::move(cubeBoxes));
+
+    // lamps don't move, their matrices are uploaded once
+    InstanceTransform lampModels[POINT_LIGHT_POSITION_NUMBER];
+    for (uint i(0); i < POINT_LIGHT_POSITION_NUMBER; i++) {
+      lampModels[i] = InstanceTransform(
+          Transform(pointLightPositions[i], glm::vec3(0.25f),
+                    glm::quat(1.0f, 0.0f, 0.0f, 0.0f)));
+    }
+    VertexBuffer<InstanceTransform> lampInstances =
+        VertexBuffer<InstanceTransform>(lampModels,
+                                        POINT_LIGHT_POSITION_NUMBER);
+    lightCubeVAO.addBuffer(lampInstances, instanceLayout);
+
+    // Material maps, the layers of a single array texture so the cubes bind
+    // one texture whatever the number of materials. The maps are decoded in
+    // parallel by the pool and streamed by the render loop once ready, until
+    // then every layer shows a single black pixel
+    const GLint diffuseLayer = 0, specularLayer = 1, emissionLayer = 2;
+    const std::vector<std::string> materialPaths = {
+        "../resources/container2.png", "../resources/container2_specular.png",
+        "../resources/matrix.jpg"};
+    if (materialPaths.size() > size_t(MAX_MATERIAL_LAYERS))
+      throw std::runtime_error("more material maps than MAX_MATERIAL_LAYERS");
+    TextureArray materialMaps(static_cast<GLsizei>(materialPaths.size()));
+
+    ThreadPool threadPool;
+    TextureLoader textureLoader(threadPool);
+    textureLoader.load(materialMaps, materialPaths);
 
     // Programs
     Program cubeProgram(Program(cubeVertShaderSrc, cubeFragShaderSrc));
     Program lightProgram(Program(cubeVertShaderSrc, lightFragShaderSrc));
 
+    // Uniform blocks, written once per frame and shared by both programs
+    UniformBlock<LightingBlock> lightingBlock(LIGHTING_BLOCK_BINDING);
+    UniformBlock<CameraBlock> cameraBlock(CAMERA_BLOCK_BINDING);
+
+    cubeProgram.bindUniformBlock("Lights", LIGHTING_BLOCK_BINDING);
+    cubeProgram.bindUniformBlock("Camera", CAMERA_BLOCK_BINDING);
+    lightProgram.bindUniformBlock("Camera", CAMERA_BLOCK_BINDING);
+
+    static_assert(POINT_LIGHT_POSITION_NUMBER == NR_POINT_LIGHTS);
+
+    // Names shown in the GL debug messages
+    cubeVAO.setLabel("cube VAO");
+    VBO.setLabel("cube vertices");
+    cubeInstances.setLabel("cube instances");
+    lightCubeVAO.setLabel("lamp VAO");
+    lampVBO.setLabel("lamp vertices");
+    lampInstances.setLabel("lamp instances");
+    materialMaps.setLabel("material maps");
+    cubeProgram.setLabel("cube program");
+    lightProgram.setLabel("lamp program");
+
+    // Uniform handles, names are only resolved here
+    char uniformName[32];
+    auto cubeObjectColor = cubeProgram.getUniformHandle<glm::vec3>("objectColor");
+    auto materialShininess =
+        cubeProgram.getUniformHandle<float>("material.shininess");
+
+    // materials only reference layers, set once
+    cubeProgram.setUniform(cubeProgram.getUniformHandle<int>("material.diffuse"),
+                           diffuseLayer);
+    cubeProgram.setUniform(
+        cubeProgram.getUniformHandle<int>("material.specular"), specularLayer);
+    cubeProgram.setUniform(
+        cubeProgram.getUniformHandle<int>("material.emission"), emissionLayer);
+    // the scales change once the maps are streamed in
+    UniformHandle<glm::vec2> layerUvScales[MAX_MATERIAL_LAYERS];
+    for (GLint layer(0); layer < materialMaps.getLayerCount(); layer++) {
+      snprintf(uniformName, sizeof(uniformName), "layerUvScales[%d]", layer);
+      layerUvScales[layer] =
+          cubeProgram.getUniformHandle<glm::vec2>(uniformName);
+    }
+    auto setLayerUvScales = [&]() {
+      for (GLint layer(0); layer < materialMaps.getLayerCount(); layer++)
+        cubeProgram.setUniform(layerUvScales[layer],
+                               materialMaps.getUvScale(layer));
+    };
+    setLayerUvScales();
+    cubeProgram.setUniformTexture2DArray("materialMaps", materialMaps);
+
+    UniformHandle<glm::vec3> lampColors[POINT_LIGHT_POSITION_NUMBER];
+    for (uint i(0); i < POINT_LIGHT_POSITION_NUMBER; i++) {
+      snprintf(uniformName, sizeof(uniformName), "colors[%d]", i);
+      lampColors[i] = lightProgram.getUniformHandle<glm::vec3>(uniformName);
+    }
+
     // - Draw parameters
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glEnable(GL_DEPTH_TEST);
+    GlState::setEnabled(GL_DEPTH_TEST, true);
 
     lastFrame = glfwGetTime();
     dt = 0;
@@ -183,132 +475,190 @@ int main() {
 
     throwOnGlError("Error in init");
 
+    // F prints the frame and pass percentiles, T writes a Chrome trace
+    Profiler profiler;
+    bool traceKeyDown = false;
+    // left click prints the cube at the center of the view
+    bool pickButtonDown = false;
+
+    // Headless target, same size as the window
+    std::optional<Framebuffer> offscreen;
+    if (options.headless) {
+      offscreen.emplace(800, 600);
+      offscreen->setLabel("headless target");
+      if (options.captureDir != nullptr)
+        std::filesystem::create_directories(options.captureDir);
+      lastFrame = 0;
+    }
+    long frameCount = 0;
+    // captured frames must not depend on how fast the maps decode
+    if (options.headless) {
+      textureLoader.uploadAll();
+      setLayerUvScales();
+    }
+
+    // Draws of a frame, sorted by state and depth before being issued
+    RenderQueue renderQueue;
+    // Per object work recorded by the pool, one list per worker
+    std::vector<CommandList> cubeLists(threadPool.getThreadCount());
+    CommandList lightingList;
+    const glm::vec3 cubesCenter = centroid(cubePositions, CUBE_POSITION_NUMBER);
+    const glm::vec3 lampsCenter =
+        centroid(pointLightPositions, POINT_LIGHT_POSITION_NUMBER);
+
     // MARK: Update
 
-    while (!glfwWindowShouldClose(window)) {
-      float time = glfwGetTime();
+    while (!glfwWindowShouldClose(window) &&
+           (options.frames == 0 || frameCount < options.frames)) {
+      // headless runs use a fixed step so every run renders the same frames
+      float time = options.headless ? frameCount * HEADLESS_FRAME_TIME
+                                    : static_cast<float>(glfwGetTime());
       dt = time - lastFrame;
       lastFrame = time;
 
+      profiler.beginFrame();
+
+      if (textureLoader.getPendingCount() > 0 &&
+          textureLoader.uploadReady() > 0)
+        setLayerUvScales();
+
       // updates
-      processInput(window);
+      if (!options.headless) {
+        processInput(window, profiler, renderQueue);
+        if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !traceKeyDown) {
+          profiler.writeChromeTrace("frame_trace.json");
+          std::cout << "trace written to frame_trace.json" << std::endl;
+        }
+        traceKeyDown = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+
+        bool pickButton =
+            glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        if (pickButton && !pickButtonDown) {
+          // the cursor is captured, the camera looks through the view center
+          std::optional<RayHit> hit =
+              cubeBvh.raycast(camera.getPosition(), camera.getFront());
+          if (hit)
+            std::cout << "picked cube " << hit->primitive << " at "
+                      << hit->distance << std::endl;
+        }
+        pickButtonDown = pickButton;
+      }
+      GlState::resetStats();
 
       // renders
+      if (offscreen)
+        offscreen->bind();
       const glm::vec3 CLEAR_COLOR = glm::vec3(0.1f);
       glClearColor(CLEAR_COLOR.r, CLEAR_COLOR.g, CLEAR_COLOR.b, 1.0f);
       glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-      glm::mat4 projection = camera.getProjectionMat();
-      glm::mat4 view = camera.getViewMat();
-
-      // Cubes
-
-      cubeVAO.bind();
-      for (int i(0); i < CUBE_POSITION_NUMBER; i++) {
-        auto cubePos = cubePositions[i];
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), cubePos);
-        model = glm::rotate(
-            model, time,
-            glm::vec3(cos(i), sin(i),
-                      (static_cast<float>(i) / CUBE_POSITION_NUMBER)));
-
-        cubeProgram.setUniform3f("objectColor", 1.0f, 0.5f, 0.31f);
-
-        // Sun
-        cubeProgram.setUniform3f("dirLight.direction", -0.2f, -1.0f, -0.3f);
-        cubeProgram.setUniform3f("dirLight.ambient", CLEAR_COLOR);
-        cubeProgram.setUniform3f("dirLight.diffuse", CLEAR_COLOR);
-        cubeProgram.setUniform3f("dirLight.specular", CLEAR_COLOR);
-
-        // Points
-        char* attribName = new char[32];
-        for (uint j(0); j < POINT_LIGHT_POSITION_NUMBER; j++) {
-          auto timePalette = palette(time / (j + 2));
-
-          snprintf(attribName, 32, "pointLights[%d].%s", j, "position");
-          cubeProgram.setUniform3f(attribName, pointLightPositions[j]);
-
-          snprintf(attribName, 32, "pointLights[%d].%s", j, "constant");
-          cubeProgram.setUniform1f(attribName, 1.0f);
-
-          snprintf(attribName, 32, "pointLights[%d].%s", j, "linear");
-          cubeProgram.setUniform1f(attribName, 0.09f);
-
-          snprintf(attribName, 32, "pointLights[%d].%s", j, "quadratic");
-          cubeProgram.setUniform1f(attribName, 0.032f);
-
-          snprintf(attribName, 32, "pointLights[%d].%s", j, "ambient");
-          cubeProgram.setUniform3f(attribName, timePalette);
-
-          snprintf(attribName, 32, "pointLights[%d].%s", j, "diffuse");
-          cubeProgram.setUniform3f(attribName, CLEAR_COLOR);
-
-          snprintf(attribName, 32, "pointLights[%d].%s", j, "specular");
-          cubeProgram.setUniform3f(attribName, timePalette);
-        }
-        delete[] attribName;
-
-        // Spot
-        const glm::vec3 CAMERA_SPOT_COLOR(1.0f);
-        cubeProgram.setUniform3f("spotLight.position", camera.getPosition());
-        cubeProgram.setUniform3f("spotLight.direction", camera.getFront());
-        cubeProgram.setUniform1f("spotLight.cutOff",
-                                 glm::cos(glm::radians(12.5f)));
-        cubeProgram.setUniform1f("spotLight.outerCutOff",
-                                 glm::cos(glm::radians(15.0f)));
-
-        cubeProgram.setUniform3f("spotLight.ambient", CLEAR_COLOR);
-        cubeProgram.setUniform3f("spotLight.diffuse", CAMERA_SPOT_COLOR);
-        cubeProgram.setUniform3f("spotLight.specular", CAMERA_SPOT_COLOR);
-
-        cubeProgram.setUniform1f("spotLight.constant", 1.0f);
-        cubeProgram.setUniform1f("spotLight.linear", 0.09f);
-        cubeProgram.setUniform1f("spotLight.quadratic", 0.032f);
-
-        cubeProgram.setUniform3f("viewPos", camera.getPosition());
-
-        cubeProgram.setUniformTexture2D("material.diffuse", diffuse);
-        cubeProgram.setUniformTexture2D("material.specular", specular);
-        cubeProgram.setUniformTexture2D("material.emission", emission);
-        cubeProgram.setUniform1f("material.shininess", 32.0f);
+      // Camera
+      CameraBlock& cameraData = cameraBlock.get();
+      cameraData.view = camera.getViewMat();
+      cameraData.projection = camera.getProjectionMat();
+      cameraData.viewPos = camera.getPosition();
+      cameraBlock.upload();
+
+      // Lights, packed by a worker while the others build the cube matrices
+      const glm::vec3 spotPosition = camera.getPosition();
+      const glm::vec3 spotDirection = camera.getFront();
+      std::future<void> lightingRecorded = threadPool.submit([&, time]() {
+        lightingList.clear();
+        lightingList.setUniformBlock(
+            lightingBlock,
+            buildLighting(time, CLEAR_COLOR, spotPosition, spotDirection));
+      });
+
+      // Cubes out of the view are not drawn, the visible ones are packed
+      // at the start of the instance buffer
+      {
+        CpuScope cpuScope(profiler, "culling");
+        cullSpheres(camera.getFrustum(), cubeBounds, visibleCubes);
+      }
 
-        cubeProgram.setUniformMat4fv("view", glm::value_ptr(view));
-        cubeProgram.setUniformMat4fv("projection", glm::value_ptr(projection));
-        cubeProgram.setUniformMat4fv("model", glm::value_ptr(model));
+      // each worker writes the matrices of its range straight in the upload
+      // command, after the buffer is orphaned
+      cubeInstances.uploadData(nullptr, CUBE_POSITION_NUMBER, GL_STREAM_DRAW);
+      recordParallel(
+          threadPool, cubeLists, visibleCubes.size(),
+          [&](CommandList& list, size_t begin, size_t end) {
+            auto* models = static_cast<InstanceTransform*>(list.uploadBuffer(
+                cubeInstances.getGlId(), begin * sizeof(InstanceTransform),
+                (end - begin) * sizeof(InstanceTransform)));
+            for (size_t k(begin); k < end; k++) {
+              const size_t i = visibleCubes[k];
+              glm::vec3 axis = glm::vec3(
+                  cos(i), sin(i),
+                  (static_cast<float>(i) / CUBE_POSITION_NUMBER));
+              cubeTransforms[i].setRotation(
+                  glm::angleAxis(time, glm::normalize(axis)));
+              models[k - begin] = InstanceTransform(cubeTransforms[i]);
+            }
+          });
+      lightingRecorded.get();
+
+      // the GL thread only replays what the workers recorded
+      {
+        CpuScope cpuScope(profiler, "replay");
+        lightingList.replay(renderQueue);
+        for (const CommandList& list : cubeLists) list.replay(renderQueue);
+      }
 
-        cubeProgram.useProgram();
+      cubeProgram.setUniform(cubeObjectColor, glm::vec3(1.0f, 0.5f, 0.31f));
+      cubeProgram.setUniform(materialShininess, 32.0f);
 
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+      // an instance count of 0 would be a plain draw
+      if (!visibleCubes.empty()) {
+        DrawSubmission cubeDraw{&cubeProgram, &cubeVAO};
+        cubeDraw.depth = glm::distance(camera.getPosition(), cubesCenter);
+        cubeDraw.instanceCount = static_cast<GLsizei>(visibleCubes.size());
+        renderQueue.submit(cubeDraw);
       }
 
       // Lamp
 
-      for (uint i(0); i < POINT_LIGHT_POSITION_NUMBER; i++) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, pointLightPositions[i]);
-        model = glm::scale(model, glm::vec3(0.5f));
+      for (uint i(0); i < POINT_LIGHT_POSITION_NUMBER; i++)
+        lightProgram.setUniform(lampColors[i], palette(time / (i + 2)));
 
-        auto timePalette = palette(time / (i + 2));
-        lightProgram.setUniformMat4fv("model", glm::value_ptr(model));
-        lightProgram.setUniformMat4fv("view", glm::value_ptr(view));
-        lightProgram.setUniformMat4fv("projection", glm::value_ptr(projection));
-        lightProgram.setUniform3f("color", timePalette);
-        lightProgram.useProgram();
+      DrawSubmission lampDraw{&lightProgram, &lightCubeVAO};
+      lampDraw.depth = glm::distance(camera.getPosition(), lampsCenter);
+      lampDraw.instanceCount = POINT_LIGHT_POSITION_NUMBER;
+      renderQueue.submit(lampDraw);
 
-        lightCubeVAO.bind();
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+      {
+        CpuScope cpuScope(profiler, "scene pass");
+        GpuScope gpuScope(profiler, "scene pass");
+        renderQueue.flush();
       }
 
-      // check and call events and swap the buffers
+      if (options.captureDir != nullptr) {
+        char frameName[32];
+        snprintf(frameName, sizeof(frameName), "frame_%05ld.png", frameCount);
+        std::string framePath =
+            (std::filesystem::path(options.captureDir) / frameName).string();
+        offscreen->writePng(framePath.c_str());
+      }
+
+      // check and call events and swap the buffers, headless runs swap too
+      // so the driver paces them like windowed frames
       glfwSwapBuffers(window);
       glfwPollEvents();
+      profiler.endFrame();
+      frameCount++;
 
-      // check for errors
-      throwOnGlError("error detected after update");
+      // the debug output already reports errors as they happen, polling
+      // glGetError is only the fallback
+      if (!GlDebugOutput::isActive())
+        throwOnGlError("error detected after update");
     }
 
+    if (options.headless)
+      profiler.printStats(std::cout);
+
     // MARK: Cleaning
     //[...]
   }
+  // after every GL object is deleted, while the context is alive
+  GlDebugOutput::shutdown();
   glfwTerminate();
 }
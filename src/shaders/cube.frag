@@ -1,11 +1,13 @@
 #version 330 core
 
 // -- Struct Def --
+// Lights are read from the std140 Lights block, keep them in sync with Lighting.hpp
 
+// the maps are layers of materialMaps
 struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
-    sampler2D emission;
+    int diffuse;
+    int specular;
+    int emission;
     float shininess;
 };
 
@@ -52,13 +54,26 @@ in vec2 UV;
 
 // -- Uniforms --
 
-uniform vec3 viewPos;
 uniform Material material;
 
+#define MAX_MATERIAL_LAYERS 16
+uniform sampler2DArray materialMaps;
+uniform vec2 layerUvScales[MAX_MATERIAL_LAYERS]; // the layer part holding the image
+
+// -- Uniform blocks --
+
 #define NR_POINT_LIGHTS 4
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform DirLight dirLight;
-uniform SpotLight spotLight;
+layout (std140) uniform Lights {
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+};
+
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
 
 // -- Attributs out --
 
@@ -69,6 +84,7 @@ out vec4 FragColor;
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 vec3 CalcSpotLight(SpotLight spotLight, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 sampleLayer(int layer);
 
 // -- --
 
@@ -87,6 +103,12 @@ void main() {
     FragColor = vec4(result, 1.0);
 }
 
+// -- Material maps --
+
+vec3 sampleLayer(int layer) {
+    return texture(materialMaps, vec3(UV * layerUvScales[layer], layer)).rgb;
+}
+
 // -- Lights compute functions --
 
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir) {
@@ -97,9 +119,9 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir) {
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
 
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, UV));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, UV));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, UV));
+    vec3 ambient = light.ambient * sampleLayer(material.diffuse);
+    vec3 diffuse = light.diffuse * diff * sampleLayer(material.diffuse);
+    vec3 specular = light.specular * spec * sampleLayer(material.specular);
     return (ambient + diffuse + specular);
 }
 
@@ -115,9 +137,9 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
     float attenuation = 1.0 / (light.constant + light.linear * distance +
         light.quadratic * (distance * distance));    
     // combine results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, UV));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, UV));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, UV));
+    vec3 ambient = light.ambient * sampleLayer(material.diffuse);
+    vec3 diffuse = light.diffuse * diff * sampleLayer(material.diffuse);
+    vec3 specular = light.specular * spec * sampleLayer(material.specular);
     ambient *= attenuation;
     diffuse *= attenuation;
     specular *= attenuation;
@@ -128,19 +150,19 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
     vec3 lightDir = normalize(light.position - fragPos);
 
     // ambient
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, UV));
+    vec3 ambient = light.ambient * sampleLayer(material.diffuse);
 
     // diffuse 
     float diff = max(dot(normal, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, UV));
+    vec3 diffuse = light.diffuse * diff * sampleLayer(material.diffuse);
 
     // specular
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = light.specular * (spec * vec3(texture(material.specular, UV)));  
+    vec3 specular = light.specular * (spec * sampleLayer(material.specular));  
 
     //emission
-    vec3 emission = texture(material.emission, UV).rgb * 0.1;
+    vec3 emission = sampleLayer(material.emission) * 0.1;
 
     // attenuation    
     float distance = length(light.position - fragPos);
@@ -2,20 +2,27 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aUV;
+// per instance
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in mat3 aNormalMatrix;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 UV;
+flat out int InstanceID;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Normal = aNormalMatrix * aNormal;
     UV = aUV;
+    InstanceID = gl_InstanceID;
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
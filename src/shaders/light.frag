@@ -1,9 +1,12 @@
 #version 330 core
 
-uniform vec3 color;
+#define NR_POINT_LIGHTS 4
+uniform vec3 colors[NR_POINT_LIGHTS];
+
+flat in int InstanceID;
 
 out vec4 FragColor;
 
 void main() {
-    FragColor = vec4(color, 1.0);
+    FragColor = vec4(colors[InstanceID], 1.0);
 }
\ No newline at end of file
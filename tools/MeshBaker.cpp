@@ -0,0 +1,34 @@
+/*
+Bakes a Wavefront OBJ file into the binary .mesh format read by MeshFile.
+Run by the build for every OBJ file of resources, see bake_mesh in CMakeLists.txt.
+
+usage : MeshBaker input.obj output.mesh
+*/
+
+#include <exception>
+#include <iostream>
+
+#include "MeshFile.hpp"
+#include "ObjLoader.hpp"
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage : " << argv[0] << " input.obj output.mesh\n";
+        return 1;
+    }
+
+    try {
+        MeshData mesh = loadObj(argv[1]);
+
+        // position, normal, uv as produced by loadObj
+        VertexLayout layout = VertexLayout().push<GLfloat>(3).push<GLfloat>(3).push<GLfloat>(2);
+        writeMeshFile(argv[2], mesh, layout);
+
+        std::cout << argv[1] << " -> " << argv[2] << " : " << mesh.vertices.size() / mesh.stride
+                  << " vertices, " << mesh.indices.size() / 3 << " triangles\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+Compresses a png/jpg image into a .dds file read by DdsFile: DXT1 when the
+image is opaque, DXT5 otherwise, with the whole mip chain.
+Run by the build for every image of resources, see compress_texture in
+CMakeLists.txt.
+
+usage : TextureCompressor input.png output.dds
+*/
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+#define STB_DXT_IMPLEMENTATION
+#include <stb/stb_dxt.h>
+
+#include "Dds.hpp"
+#include "gl_utils.hpp"
+
+// RGBA8 image, rows bottom up as OpenGL expects them
+struct Image {
+    std::vector<unsigned char> pixels;
+    size_t width;
+    size_t height;
+
+    const unsigned char* at(size_t x, size_t y) const { return &pixels[(y * width + x) * 4]; }
+};
+
+static Image loadImage(const char* path) {
+    // same orientation as the textures loaded through Texture::decodeImage
+    stbi_set_flip_vertically_on_load(true);
+
+    int width, height, channels;
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 4);
+    if (!data)
+        throw std::runtime_error(std::string("could not load the image : ") + path + " : " + stbi_failure_reason());
+
+    Image image{std::vector<unsigned char>(data, data + size_t(width) * height * 4), size_t(width), size_t(height)};
+    stbi_image_free(data);
+    return image;
+}
+
+static bool isOpaque(const Image& image) {
+    for (size_t i = 3; i < image.pixels.size(); i += 4)
+        if (image.pixels[i] != 255)
+            return false;
+    return true;
+}
+
+// 2x2 box filter, the last row/column is repeated on odd sizes
+static Image halve(const Image& image) {
+    Image half{{}, std::max<size_t>(image.width / 2, 1), std::max<size_t>(image.height / 2, 1)};
+    half.pixels.resize(half.width * half.height * 4);
+
+    for (size_t y = 0; y < half.height; y++) {
+        for (size_t x = 0; x < half.width; x++) {
+            size_t x0 = std::min(x * 2, image.width - 1), x1 = std::min(x * 2 + 1, image.width - 1);
+            size_t y0 = std::min(y * 2, image.height - 1), y1 = std::min(y * 2 + 1, image.height - 1);
+
+            for (size_t c = 0; c < 4; c++) {
+                unsigned sum = image.at(x0, y0)[c] + image.at(x1, y0)[c] + image.at(x0, y1)[c] + image.at(x1, y1)[c];
+                half.pixels[(y * half.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return half;
+}
+
+// Compresses every 4x4 block, the blocks crossing the border clamp to the edge
+static std::vector<unsigned char> compress(const Image& image, GLenum internalFormat) {
+    const bool alpha = internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    const size_t blockSize = glCompressedBlockSize(internalFormat);
+
+    std::vector<unsigned char> blocks(glCompressedImageSize(internalFormat, image.width, image.height));
+    unsigned char* destination = blocks.data();
+    unsigned char block[16 * 4];
+
+    for (size_t by = 0; by < image.height; by += 4) {
+        for (size_t bx = 0; bx < image.width; bx += 4) {
+            for (size_t y = 0; y < 4; y++) {
+                for (size_t x = 0; x < 4; x++) {
+                    const unsigned char* pixel =
+                        image.at(std::min(bx + x, image.width - 1), std::min(by + y, image.height - 1));
+                    std::copy(pixel, pixel + 4, block + (y * 4 + x) * 4);
+                }
+            }
+            stb_compress_dxt_block(destination, block, alpha, STB_DXT_HIGHQUAL);
+            destination += blockSize;
+        }
+    }
+    return blocks;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage : " << argv[0] << " input.png output.dds\n";
+        return 1;
+    }
+
+    try {
+        Image image = loadImage(argv[1]);
+        const GLenum internalFormat =
+            isOpaque(image) ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        const size_t width = image.width, height = image.height;
+
+        std::vector<std::vector<unsigned char>> levels;
+        size_t compressedSize = 0, rawSize = 0;
+        while (true) {
+            levels.push_back(compress(image, internalFormat));
+            compressedSize += levels.back().size();
+            rawSize += image.pixels.size();
+
+            if (image.width == 1 && image.height == 1)
+                break;
+            image = halve(image);
+        }
+
+        writeDds(argv[2], internalFormat, width, height, levels);
+
+        std::cout << argv[1] << " -> " << argv[2] << " : " << width << "x" << height << " "
+                  << (internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? "DXT1" : "DXT5") << ", "
+                  << levels.size() << " levels, " << rawSize / 1024 << " KB -> " << compressedSize / 1024
+                  << " KB\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}